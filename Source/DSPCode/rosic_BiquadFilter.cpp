@@ -4,7 +4,8 @@ using namespace rosic;
 //-------------------------------------------------------------------------------------------------
 // construction/destruction:
 
-BiquadFilter::BiquadFilter()
+template<class T>
+BiquadFilterT<T>::BiquadFilterT()
 {
   frequency  = 1000.0;
   gain       = 0.0;
@@ -18,32 +19,37 @@ BiquadFilter::BiquadFilter()
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void BiquadFilter::setSampleRate(double newSampleRate)
+template<class T>
+void BiquadFilterT<T>::setSampleRate(double newSampleRate)
 {
   if( newSampleRate > 0.0 )
     sampleRate = newSampleRate;
   calcCoeffs();
 }
 
-void BiquadFilter::setMode(int newMode)
+template<class T>
+void BiquadFilterT<T>::setMode(int newMode)
 {
   mode = newMode; // 0:bypass, 1:Low Pass, 2:High Pass
   calcCoeffs();
 }
 
-void BiquadFilter::setFrequency(double newFrequency)
+template<class T>
+void BiquadFilterT<T>::setFrequency(double newFrequency)
 {
   frequency = newFrequency;
   calcCoeffs();
 }
 
-void BiquadFilter::setGain(double newGain)
+template<class T>
+void BiquadFilterT<T>::setGain(double newGain)
 {
   gain = newGain;
   calcCoeffs();
 }
 
-void BiquadFilter::setBandwidth(double newBandwidth)
+template<class T>
+void BiquadFilterT<T>::setBandwidth(double newBandwidth)
 {
   bandwidth = newBandwidth;
   calcCoeffs();
@@ -52,7 +58,8 @@ void BiquadFilter::setBandwidth(double newBandwidth)
 //-------------------------------------------------------------------------------------------------
 //others:
 
-void BiquadFilter::calcCoeffs()
+template<class T>
+void BiquadFilterT<T>::calcCoeffs()
 {
   double w = 2*PI*frequency/sampleRate;
   double s, c;
@@ -180,10 +187,17 @@ void BiquadFilter::calcCoeffs()
   }
 }
 
-void BiquadFilter::reset()
+template<class T>
+void BiquadFilterT<T>::reset()
 {
   x1 = 0.0;
   x2 = 0.0;
   y1 = 0.0;
   y2 = 0.0;
 }
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::BiquadFilterT<double>;
+template class rosic::BiquadFilterT<float>;
@@ -9,13 +9,18 @@ namespace rosic
 
   /**
 
-  This is an implementation of a simple one-pole filter unit.
+  This is an implementation of a simple one-pole filter unit. The template parameter is the type
+  of the signal and the filter coefficients (float or double), the parameters are always double.
 
   */
 
-  class BiquadFilter
+  template<class T>
+  class BiquadFilterT
   {
 
+    template<int numLanes> friend class Open303xN; // copies coefficients and states
+    template<class> friend class PostFilterChainT; // runs the filters in a fused loop
+
   public:
 
     /** Enumeration of the available filter modes. */
@@ -40,7 +45,7 @@ namespace rosic
     // construction/destruction:
 
     /** Constructor. */
-    BiquadFilter();   
+    BiquadFilterT();   
 
     //---------------------------------------------------------------------------------------------
     // parameter settings:
@@ -79,7 +84,12 @@ namespace rosic
     // audio processing:
 
     /** Calculates a single filtered output-sample. */
-    INLINE double getSample(double in);
+    INLINE T getSample(T in);
+
+    /** The calculation of getSample on coefficients and states that are passed in (the states are 
+    updated) - shared with the loops that keep the filters in local variables or lanes 
+    (PostFilterChainT, Open303xN). */
+    static INLINE T processSample(T in, T b0, T b1, T b2, T a1, T a2, T &x1, T &x2, T &y1, T &y2);
 
     //---------------------------------------------------------------------------------------------
     // others:
@@ -94,8 +104,8 @@ namespace rosic
     // internal functions:
     void calcCoeffs();  // calculates filter coefficients from filter parameters
 
-    double b0, b1, b2, a1, a2;
-    double x1, x2, y1, y2;
+    T b0, b1, b2, a1, a2;
+    T x1, x2, y1, y2;
 
     double frequency, gain, bandwidth;
     double sampleRate;
@@ -106,10 +116,18 @@ namespace rosic
   //-----------------------------------------------------------------------------------------------
   // inlined functions:
 
-  INLINE double BiquadFilter::getSample(double in)
+  template<class T>
+  INLINE T BiquadFilterT<T>::getSample(T in)
+  {
+    return processSample(in, b0, b1, b2, a1, a2, x1, x2, y1, y2);
+  }
+
+  template<class T>
+  INLINE T BiquadFilterT<T>::processSample(T in, T b0, T b1, T b2, T a1, T a2, 
+                                           T &x1, T &x2, T &y1, T &y2)
   {
     // calculate the output sample:
-    double y = b0*in + b1*x1 + b2*x2 + a1*y1 + a2*y2 + TINY;
+    T y = b0*in + b1*x1 + b2*x2 + a1*y1 + a2*y2 + TINY;
 
     // update the buffer variables:
     x2 = x1;
@@ -120,6 +138,8 @@ namespace rosic
     return y;
   }
 
+  typedef BiquadFilterT<double> BiquadFilter;
+
 } // end namespace rosic
 
 #endif // rosic_BiquadFilter_h
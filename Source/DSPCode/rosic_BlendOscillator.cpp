@@ -4,30 +4,41 @@ using namespace rosic;
 //-------------------------------------------------------------------------------------------------
 // construction/destruction:
 
-BlendOscillator::BlendOscillator()
+template<class T>
+BlendOscillatorT<T>::BlendOscillatorT()
 {
   // init member variables:
-  tableLengthDbl       = (double) MipMappedWaveTable::tableLength;  // typecasted version
+  tableLengthDbl       = (double) MipMappedWaveTableT<T>::tableLength;  // typecasted version
   sampleRate           = 44100.0;
   freq                 = 440.0;
   increment            = (tableLengthDbl*freq)/sampleRate;
   phaseIndex           = 0.0;
   startIndex           = 0.0;
+  blend                = 0.0;
   waveTable1           = NULL;
   waveTable2           = NULL;
+  algorithm            = MIP_MAP;
+  squareFactor         = 0.0;
+  squareOffset         = 0.0;
+  squarePhaseShift     = 0.0;
+  squareShift          = 0.0;
+  squareStep           = 0.0;
+  squareKink           = 0.0;
+  squareDC             = 0.0;
 
   // somewhat redundant:
   setSampleRate(44100.0);          // sampleRate = 44100 Hz by default
   setFrequency (440.0);            // frequency = 440 Hz by default
   setStartPhase(0.0);              // sartPhase = 0 by default
 
-  setWaveForm1(MipMappedWaveTable::SAW);
-  setWaveForm2(MipMappedWaveTable::SQUARE);
+  setWaveForm1(MipMappedWaveTableT<T>::SAW);
+  setWaveForm2(MipMappedWaveTableT<T>::SQUARE);
 
   resetPhase();
 }
 
-BlendOscillator::~BlendOscillator()
+template<class T>
+BlendOscillatorT<T>::~BlendOscillatorT()
 {
 
 }
@@ -35,7 +46,8 @@ BlendOscillator::~BlendOscillator()
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void BlendOscillator::setSampleRate(double newSampleRate)
+template<class T>
+void BlendOscillatorT<T>::setSampleRate(double newSampleRate)
 {
   if( newSampleRate > 0.0 )
     sampleRate = newSampleRate;
@@ -43,29 +55,41 @@ void BlendOscillator::setSampleRate(double newSampleRate)
   increment = tableLengthDbl*freq*sampleRateRec;
 }
 
-void BlendOscillator::setWaveForm1(int newWaveForm1)
+template<class T>
+void BlendOscillatorT<T>::setWaveForm1(int newWaveForm1)
 {
   if( waveTable1 != NULL )
     waveTable1->setWaveform(newWaveForm1);
 }
 
-void BlendOscillator::setWaveForm2(int newWaveForm2)
+template<class T>
+void BlendOscillatorT<T>::setWaveForm2(int newWaveForm2)
 {
   if( waveTable2 != NULL )
     waveTable2->setWaveform(newWaveForm2);
 }
 
-void BlendOscillator::setWaveTable1(MipMappedWaveTable* newWaveTable1)
+template<class T>
+void BlendOscillatorT<T>::setWaveTable1(MipMappedWaveTableT<T>* newWaveTable1)
 {
   waveTable1 = newWaveTable1;
 }
 
-void BlendOscillator::setWaveTable2(MipMappedWaveTable* newWaveTable2)
+template<class T>
+void BlendOscillatorT<T>::setWaveTable2(MipMappedWaveTableT<T>* newWaveTable2)
 {
   waveTable2 = newWaveTable2;
 }
 
-void BlendOscillator::setStartPhase(double StartPhase)
+template<class T>
+void BlendOscillatorT<T>::setAlgorithm(int newAlgorithm)
+{
+  if( newAlgorithm >= 0 && newAlgorithm < NUM_ALGORITHMS )
+    algorithm = newAlgorithm;
+}
+
+template<class T>
+void BlendOscillatorT<T>::setStartPhase(double StartPhase)
 {
   if( (StartPhase>=0) && (StartPhase<=360) )
     startIndex = (StartPhase/360.0)*tableLengthDbl;
@@ -74,12 +98,44 @@ void BlendOscillator::setStartPhase(double StartPhase)
 //-------------------------------------------------------------------------------------------------
 // event processing:
 
-void BlendOscillator::resetPhase()
+template<class T>
+void BlendOscillatorT<T>::resetPhase()
 {
   phaseIndex = startIndex;
 }
 
-void BlendOscillator::setPhase(double PhaseIndex)
+template<class T>
+void BlendOscillatorT<T>::setPhase(double PhaseIndex)
 {
   phaseIndex = startIndex+PhaseIndex;
 }
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+template<class T>
+void BlendOscillatorT<T>::updateSquareShape()
+{
+  // the square is -tanh(a*s+b) with the saw s between -1...1 (rising by 2 per cycle), the jump 
+  // goes from s = 1 to s = -1:
+  double a = squareFactor = waveTable2->tanhShaperFactor;
+  double b = squareOffset = waveTable2->tanhShaperOffset;
+  double yBefore = -tanh( a+b);
+  double yAfter  = -tanh(-a+b);
+  squareStep = yAfter - yBefore;
+  squareKink = -2.0*a*(1.0-yAfter*yAfter) + 2.0*a*(1.0-yBefore*yBefore);
+
+  // the mean value is the integral of -tanh(a*s+b) over s divided by 2, the integral of tanh is 
+  // log(cosh(x)) = |x| + log(1+exp(-2|x|)) - log(2):
+  double x1 = fabs(a+b), x2 = fabs(-a+b);
+  squareDC  = -(x1 + log1p(exp(-2.0*x1)) - x2 - log1p(exp(-2.0*x2))) / (2.0*a);
+
+  squarePhaseShift = waveTable2->squarePhaseShift;
+  squareShift      = squarePhaseShift/360.0 - floor(squarePhaseShift/360.0);
+}
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::BlendOscillatorT<double>;
+template class rosic::BlendOscillatorT<float>;
@@ -3,6 +3,8 @@
 
 // rosic-indcludes:
 #include "rosic_MipMappedWaveTable.h"
+#include "rosic_FastMath.h"
+#include "rosic_CpuDispatch.h"
 
 namespace rosic
 {
@@ -11,23 +13,45 @@ namespace rosic
 
   This is an oscillator that can continuously blend between two waveforms - this is more efficient
   than using two separate oscillators because the phase-accumulator has to be calculated only once
-  for both waveforms.
+  for both waveforms. The template parameter is the type of the output signal and the wavetables 
+  (float or double) whereas the phase accumulator is always double.
+
+  With the POLY_BLEP algorithm, the oscillator doesn't read the wavetables but calculates the 303 
+  saw (as waveform 1) and the tanh-shaped 303 square (as waveform 2, with the shaper parameters and
+  the phase shift taken from the 2nd wavetable) directly from the phase. The jumps are smoothed by 
+  polynomial band-limited step residuals (PolyBLEP) and the kink of the square at its jump by the 
+  integrated residual (PolyBLAMP). The mip-maps are band-limited to a quarter of the sample rate 
+  (such that the oscillator needs 4x oversampling) whereas the PolyBLEP waveforms have their full 
+  bandwidth with aliases that fall off towards low frequencies, which makes lower oversampling 
+  factors usable (@see Open303::setOscillatorAlgorithm for measurements).
 
   */
 
-  class BlendOscillator
+  template<class T>
+  class BlendOscillatorT
   {
 
+    template<int numLanes> friend class Open303xN; // needs the phase, blend and wavetables
+
   public:
 
+    /** Enumeration of the ways to generate the waveforms. */
+    enum algorithms
+    {
+      MIP_MAP = 0, // lookup in the mip-mapped wavetables (default)
+      POLY_BLEP,   // 303 saw and square with polynomial band-limited steps
+
+      NUM_ALGORITHMS
+    };
+
     //---------------------------------------------------------------------------------------------
     // construction/destruction:
 
     /** Constructor. */
-    BlendOscillator();
+    BlendOscillatorT();
 
     /** Destructor. */
-    ~BlendOscillator();
+    ~BlendOscillatorT();
 
     //---------------------------------------------------------------------------------------------
     // parameter settings:
@@ -48,15 +72,15 @@ namespace rosic
     oscillator. Not to have "our own" WaveTable-object as member-variable avoids the need to have 
     the same waveform for different synth-voices multiple times in the memory. This function sets 
     the 1st wavetable. */
-    void setWaveTable1(MipMappedWaveTable* newWaveTable1);
+    void setWaveTable1(MipMappedWaveTableT<T>* newWaveTable1);
 
     /** Sets the 2nd wavetable. @see setWaveTable1 */
-    void setWaveTable2(MipMappedWaveTable* newWaveTable2);
+    void setWaveTable2(MipMappedWaveTableT<T>* newWaveTable2);
 
     /** Sets the blend/mix factor between the two waveforms. The value is expected between 0...1
     where 0 means waveform1 only, 1 means waveform2 only - in between there will be a linear blend
     between the two waveforms. */
-    void setBlendFactor(double newBlendFactor) { blend = newBlendFactor; }
+    void setBlendFactor(double newBlendFactor) { blend = (T) newBlendFactor; }
 
     /** Sets the frequency of the oscillator. */
     INLINE void setFrequency(double newFrequency);
@@ -67,6 +91,9 @@ namespace rosic
     /** Sets the phase increment from outside. */
     INLINE void setIncrement(double newIncrement) { increment = newIncrement; }
 
+    /** Selects the way to generate the waveforms (@see algorithms). */
+    void setAlgorithm(int newAlgorithm);
+
     //---------------------------------------------------------------------------------------------
     // inquiry:
 
@@ -78,11 +105,25 @@ namespace rosic
     /** Returns the phase increment. */
     INLINE double getIncrement() const { return increment; }
 
+    /** Returns the way the waveforms are generated (@see algorithms). */
+    int getAlgorithm() const { return algorithm; }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Calculates one output sample at a time. */
-    INLINE double getSample();
+    O303_KERNEL_INLINE T getSample();
+
+    /** Returns the mip-map level for the phase increment - it generates frequencies up to 
+    nyquist/4 on the highest note. */
+    static INLINE int getTableNumber(double increment);
+
+    /** The table lookup of getSample for the MIP_MAP algorithm on the tables of mip-map level 
+    'tableNumber' and a phase that are passed in (the phase is wrapped and advanced by the 
+    increment) - shared with the lanes of Open303xN. */
+    static O303_KERNEL_INLINE T processSample(const T *table1, const T *table2, int tableNumber, 
+                                              T blend, double increment, double tableLength, 
+                                              double &phaseIndex);
 
     //---------------------------------------------------------------------------------------------
     // others:
@@ -101,63 +142,114 @@ namespace rosic
 
   protected:
 
+    /** Calculates an output sample with the POLY_BLEP algorithm. */
+    INLINE T getSamplePolyBlep();
+
+    /** Returns the residual of the band-limited step of height 1 (PolyBLEP) at the distance x 
+    from the step, where x is in units of the phase increment dt. */
+    static INLINE double stepResidual(double x);
+
+    /** Returns the residual of the band-limited ramp of slope 1 per sample (PolyBLAMP) at the 
+    distance x from the kink (in units of the phase increment). */
+    static INLINE double rampResidual(double x);
+
+    /** Updates the height of the jump, the change of slope at the jump, the dc and the phase shift
+    of the 303 square when the parameters of the 2nd wavetable have changed. */
+    void updateSquareShape();
+
     double tableLengthDbl;    // tableLength as double variable
     double phaseIndex;        // current phase index
     double freq;              // frequency of the oscillator
     double increment;         // phase increment per sample
-    double blend;             // the blend factor between the two waveforms
+    T      blend;             // the blend factor between the two waveforms
     double startIndex;        // start-phase-index of the osc (range: 0 - tableLength)
     double sampleRate;        // the samplerate
     double sampleRateRec;     // 1/sampleRate
+    int    algorithm;         // the way to generate the waveforms
+
+    // the parameters from which the square shape has been calculated (for POLY_BLEP):
+    double squareFactor, squareOffset, squarePhaseShift;
+    double squareShift;       // the phase shift in cycles (0...1)
+    double squareStep;        // height of the jump of the 303 square
+    double squareKink;        // change of slope (per cycle) at the jump
+    double squareDC;          // mean value of the 303 square
 
-    MipMappedWaveTable *waveTable1, *waveTable2; // the 2 wavetables between which we blend
+    MipMappedWaveTableT<T> *waveTable1, *waveTable2; // the 2 wavetables between which we blend
 
   };
 
   //-----------------------------------------------------------------------------------------------
   // inlined functions:
 
-  INLINE void BlendOscillator::setFrequency(double newFrequency)
+  template<class T>
+  INLINE void BlendOscillatorT<T>::setFrequency(double newFrequency)
   {
     if( (newFrequency > 0.0) && (newFrequency < 20000.0) )
       freq = newFrequency;
   }
 
-  INLINE void BlendOscillator::setPulseWidth(double newPulseWidth)
+  template<class T>
+  INLINE void BlendOscillatorT<T>::setPulseWidth(double newPulseWidth)
   {
     waveTable1->setSymmetry(0.01*newPulseWidth);
     waveTable2->setSymmetry(0.01*newPulseWidth);
   }
 
-  INLINE void BlendOscillator::calculateIncrement()
+  template<class T>
+  INLINE void BlendOscillatorT<T>::calculateIncrement()
   {
     increment = tableLengthDbl*freq*sampleRateRec;
   }
 
-  INLINE double BlendOscillator::getSample()
+  template<class T>
+  O303_KERNEL_INLINE T BlendOscillatorT<T>::getSample()
   {
-    double out1, out2;
-    int    tableNumber;
-
     if( waveTable1 == NULL || waveTable2 == NULL )
       return 0.0;
 
+    if( algorithm == POLY_BLEP )
+      return getSamplePolyBlep();
+
+    int tableNumber = getTableNumber(increment);
+    return processSample(waveTable1->tableSet[tableNumber], waveTable2->tableSet[tableNumber], 
+                         tableNumber, blend, increment, tableLengthDbl, phaseIndex);
+  }
+
+  template<class T>
+  INLINE int BlendOscillatorT<T>::getTableNumber(double increment)
+  {
     // from this increment, decide which table is to be used:
-    tableNumber  = ((int)EXPOFDBL(increment));
+    int tableNumber  = ((int)EXPOFDBL(increment));
     //tableNumber += 1;           // generate frequencies up to nyquist/2 on the highest note
     tableNumber += 2;             // generate frequencies up to nyquist/4 on the highest note
                                   // \todo: make this number adjustable from outside
+    if( tableNumber <= 0 )
+      tableNumber = 0;
+    else if( tableNumber >= MipMappedWaveTableT<T>::numTables )
+      tableNumber = MipMappedWaveTableT<T>::numTables-1;
+    return tableNumber;
+  }
 
+  template<class T>
+  O303_KERNEL_INLINE T BlendOscillatorT<T>::processSample(const T *table1, const T *table2, 
+                                                          int tableNumber, T blend, 
+                                                          double increment, double tableLength, 
+                                                          double &phaseIndex)
+  {
     // wraparound if necessary:
-    while( phaseIndex>=tableLengthDbl )
-      phaseIndex -= tableLengthDbl;
-
-    int    intIndex = floorInt(phaseIndex);
-    double frac     = phaseIndex  - (double) intIndex;
-    out1 = (1.0-blend) * waveTable1->getValueLinear(intIndex, frac, tableNumber);
-    out2 =      blend  * waveTable2->getValueLinear(intIndex, frac, tableNumber);
+    while( phaseIndex>=tableLength )
+      phaseIndex -= tableLength;
+
+    // the higher tables are shorter, so the position in the table is the scaled phase:
+    double tableIndex = phaseIndex * MipMappedWaveTableT<T>::getIndexScale(tableNumber);
+    int    intIndex   = floorInt(tableIndex);
+    T      frac       = (T) (tableIndex - (double) intIndex);
+    T      weights[4];
+    MipMappedWaveTableT<T>::getWeights(frac, tableNumber, weights);
+    T out1 = (T(1)-blend) * MipMappedWaveTableT<T>::interpolate(table1, intIndex, weights);
+    T out2 =       blend  * MipMappedWaveTableT<T>::interpolate(table2, intIndex, weights);
     
-    out2 *= 0.5; // \todo: this is preliminary to scale the square in AciDevil we need to
+    out2 *= T(0.5); // \todo: this is preliminary to scale the square in AciDevil we need to
                  // implement something more general here (like a kind of crest-compensation in 
                  // the wavetable-class)
 
@@ -165,6 +257,77 @@ namespace rosic
     return out1 + out2;
   }
 
+  template<class T>
+  INLINE double BlendOscillatorT<T>::stepResidual(double x)
+  {
+    if( x >= 0.0 && x < 1.0 )
+      return -0.5 * (1.0-x) * (1.0-x);
+    if( x < 0.0 && x > -1.0 )
+      return  0.5 * (1.0+x) * (1.0+x);
+    return 0.0;
+  }
+
+  template<class T>
+  INLINE double BlendOscillatorT<T>::rampResidual(double x)
+  {
+    if( x >= 0.0 && x < 1.0 )
+      return (1.0/6.0) * (1.0-x) * (1.0-x) * (1.0-x);
+    if( x < 0.0 && x > -1.0 )
+      return (1.0/6.0) * (1.0+x) * (1.0+x) * (1.0+x);
+    return 0.0;
+  }
+
+  template<class T>
+  INLINE T BlendOscillatorT<T>::getSamplePolyBlep()
+  {
+    // wraparound if necessary:
+    while( phaseIndex>=tableLengthDbl )
+      phaseIndex -= tableLengthDbl;
+
+    // phase and increment in cycles:
+    const double cyclesPerIndex = 1.0 / MipMappedWaveTableT<T>::tableLength;
+    double p   = phaseIndex * cyclesPerIndex;
+    double dt  = increment  * cyclesPerIndex;
+    double rdt = tableLengthDbl / increment;
+    double d;
+    T      out1 = 0, out2 = 0;
+
+    // the saw rises from 0 to 1 in the first half cycle, jumps down to -1 and rises to 0 again - 
+    // d is the distance to the jump in cycles (in the wavetable, the jump is between the samples 
+    // at tableLength/2-1 and tableLength/2, i.e. half a sample before the middle):
+    const double jump = 0.5 - 0.5*cyclesPerIndex;
+    if( blend != T(1) )
+    {
+      d    = p - jump;
+      out1 = (T) (2.0*d + (d < 0.0 ? 1.0 : -1.0) - 2.0*stepResidual(d*rdt));
+    }
+
+    // the square is the tanh of the saw (with the phase shift), so it jumps (up) at the same place 
+    // and has a kink there:
+    if( blend != T(0) )
+    {
+      if(    waveTable2->tanhShaperFactor != squareFactor 
+          || waveTable2->tanhShaperOffset != squareOffset
+          || waveTable2->squarePhaseShift != squarePhaseShift )
+        updateSquareShape();
+      d = p - jump - squareShift; // -1.5...0.5
+      if( d < -0.5 )
+        d += 1.0;
+      if( d < -0.5 )
+        d += 1.0;
+      double saw = 2.0*d + (d < 0.0 ? 1.0 : -1.0);
+      double x   = d*rdt;
+      out2 = (T) (  -fastTanh<MATH_HIGH>(squareFactor*saw + squareOffset) - squareDC
+                  + squareStep * stepResidual(x) + squareKink * dt * rampResidual(x) );
+      out2 *= T(0.5); // same scaling as for the wavetable
+    }
+
+    phaseIndex += increment;
+    return (T(1)-blend) * out1 + blend * out2;
+  }
+
+  typedef BlendOscillatorT<double> BlendOscillator;
+
 } // end namespace rosic
 
 #endif // rosic_BlendOscillator_h
@@ -0,0 +1,111 @@
+#include "rosic_CpuDispatch.h"
+
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace rosic;
+
+namespace
+{
+
+  const char* const instructionSetNames[CpuDispatch::NUM_INSTRUCTION_SETS] =
+  {
+    "baseline", "avx2", "avx512"
+  };
+
+  // -1 until the detection has run:
+  std::atomic<int> detectedInstructionSet(-1);
+  std::atomic<int> selectedInstructionSet(-1);
+
+  int detectInstructionSet()
+  {
+#if O303_CPU_DISPATCH
+    // __builtin_cpu_supports also checks that the OS saves the vector registers:
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports("avx512f") )
+      return CpuDispatch::AVX512;
+    if( __builtin_cpu_supports("avx2") )
+      return CpuDispatch::AVX2;
+#endif
+    return CpuDispatch::BASELINE;
+  }
+
+  int selectInstructionSet()
+  {
+    int instructionSet = CpuDispatch::getDetectedInstructionSet();
+    const char *forced = getenv("O303_ISA");
+    if( forced != NULL )
+    {
+      int forcedInstructionSet = CpuDispatch::findInstructionSet(forced);
+      if( forcedInstructionSet >= 0 && forcedInstructionSet < instructionSet )
+        instructionSet = forcedInstructionSet;
+    }
+    return instructionSet;
+  }
+
+  // runs the detection at startup, such that it doesn't happen on the audio thread:
+  struct Initializer
+  {
+    Initializer() { CpuDispatch::getInstructionSet(); }
+  } initializer;
+
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void CpuDispatch::setInstructionSet(int newInstructionSet)
+{
+  if( newInstructionSet >= 0 && newInstructionSet < NUM_INSTRUCTION_SETS )
+  {
+    if( newInstructionSet > getDetectedInstructionSet() )
+      newInstructionSet = getDetectedInstructionSet();
+    selectedInstructionSet.store(newInstructionSet, std::memory_order_relaxed);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+int CpuDispatch::getInstructionSet()
+{
+  int instructionSet = selectedInstructionSet.load(std::memory_order_relaxed);
+  if( instructionSet < 0 )
+  {
+    // a concurrent first call makes the same selection, so it doesn't matter who stores it:
+    instructionSet = selectInstructionSet();
+    selectedInstructionSet.store(instructionSet, std::memory_order_relaxed);
+  }
+  return instructionSet;
+}
+
+int CpuDispatch::getDetectedInstructionSet()
+{
+  int instructionSet = detectedInstructionSet.load(std::memory_order_relaxed);
+  if( instructionSet < 0 )
+  {
+    instructionSet = detectInstructionSet();
+    detectedInstructionSet.store(instructionSet, std::memory_order_relaxed);
+  }
+  return instructionSet;
+}
+
+const char* CpuDispatch::getInstructionSetName(int instructionSet)
+{
+  if( instructionSet >= 0 && instructionSet < NUM_INSTRUCTION_SETS )
+    return instructionSetNames[instructionSet];
+  return "?";
+}
+
+int CpuDispatch::findInstructionSet(const char *name)
+{
+  for(int i = 0; i < NUM_INSTRUCTION_SETS; i++)
+  {
+    if( strcmp(name, instructionSetNames[i]) == 0 )
+      return i;
+  }
+  if( strcmp(name, "sse2") == 0 ) // the baseline of x86-64
+    return BASELINE;
+  return -1;
+}
@@ -0,0 +1,84 @@
+#ifndef rosic_CpuDispatch_h
+#define rosic_CpuDispatch_h
+
+#include "GlobalDefinitions.h"
+
+/** Attributes for the dispatched kernels (@see CpuDispatch). A kernel is written once as a
+function with O303_KERNEL_INLINE and called from a wrapper per instruction set that carries the
+target attribute, such that the compiler generates (and vectorizes) the inlined body for that
+instruction set. Functions that are not inlined keep the baseline instruction set, so no code for
+a newer instruction set can leak into the baseline paths. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define O303_CPU_DISPATCH 1
+#define O303_KERNEL_INLINE inline __attribute__((always_inline))
+#define O303_TARGET_AVX2   __attribute__((target("avx2")))
+#define O303_TARGET_AVX512 __attribute__((target("avx512f,prefer-vector-width=512")))
+#else
+#define O303_CPU_DISPATCH 0
+#ifdef _MSC_VER
+#define O303_KERNEL_INLINE __forceinline
+#else
+#define O303_KERNEL_INLINE inline
+#endif
+#define O303_TARGET_AVX2
+#define O303_TARGET_AVX512
+#endif
+
+namespace rosic
+{
+
+  /**
+
+  This class selects the instruction set for the hot DSP kernels at runtime, such that one binary
+  uses the vector units of the machine it runs on. The CPU features are detected once at startup,
+  the kernels ask for the selected instruction set on each call (per block) and run the variant
+  that was compiled for it. The dispatched kernels are the audio-rate part of Open303 (oscillator,
+  filters and decimation), the lanes of Open303xN, EllipticQuarterBandFilter::decimate4 and
+  PostFilterChain::processBlock.
+
+  The variants don't use FMA (the library is compiled with -ffp-contract=off), so they produce
+  the same output to the last bit - a render doesn't depend on the machine it was made on.
+
+  The selection can be forced to a lower instruction set for testing, either with the environment
+  variable O303_ISA (baseline, avx2 or avx512) or with setInstructionSet. Only GCC and Clang on
+  x86 compile the AVX2 and AVX-512 variants, elsewhere everything runs the baseline variant.
+
+  */
+
+  class CpuDispatch
+  {
+
+  public:
+
+    /** Enumeration of the instruction sets that kernels can be compiled for. */
+    enum instructionSets
+    {
+      BASELINE = 0, // whatever the library is compiled for (SSE2 on x86-64)
+      AVX2,
+      AVX512,       // AVX-512F
+
+      NUM_INSTRUCTION_SETS
+    };
+
+    /** Selects the instruction set for the kernels - it is limited to the detected one. Don't
+    call this while audio is rendered. */
+    static void setInstructionSet(int newInstructionSet);
+
+    /** Returns the instruction set that the kernels use (@see instructionSets). */
+    static int getInstructionSet();
+
+    /** Returns the best instruction set that is supported by the CPU and compiled into the
+    library. */
+    static int getDetectedInstructionSet();
+
+    /** Returns the name of an instruction set as used by O303_ISA. */
+    static const char* getInstructionSetName(int instructionSet);
+
+    /** Returns the instruction set with the given name or -1 if there is none. */
+    static int findInstructionSet(const char *name);
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_CpuDispatch_h
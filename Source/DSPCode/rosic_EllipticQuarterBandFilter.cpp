@@ -18,3 +18,85 @@ void EllipticQuarterBandFilter::reset()
     w[i] = 0.0;
 }
 
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+template<class T>
+O303_KERNEL_INLINE void EllipticQuarterBandFilter::decimate4Kernel(const T *in, T *out,
+                                                                   int numOutSamples)
+{
+  // the intermediate signal of the direct form II is written into a history line (instead of 
+  // shifting the state buffer) such that the output samples can be calculated from it afterwards,
+  // the expressions are the same as in getSample:
+  static const int chunkSize = 64;
+  double h[12+4*chunkSize];
+  double *v;
+  int    i, n, numOut, numIn;
+  while( numOutSamples > 0 )
+  {
+    numOut = numOutSamples < chunkSize ? numOutSamples : chunkSize;
+    numIn  = 4*numOut;
+    for(i=0; i<12; i++)
+      h[i] = w[11-i];
+
+    // recursive part, v[-i] is w[i-1] of getSample:
+    for(n=0; n<numIn; n++)
+    {
+      v    = &h[n+12];
+      v[0] =   ((double) in[n] + TINY)
+             - ( (a01*v[-1] + a02*v[-2] ) + (a03*v[-3]  + a04*v[-4]   ) ) 
+             - ( (a05*v[-5] + a06*v[-6] ) + (a07*v[-7]  + a08*v[-8]   ) )
+             - ( (a09*v[-9] + a10*v[-10]) + (a11*v[-11] + a12*v[-12]  ) );
+    }
+
+    // non-recursive part for the last sample of each group of 4:
+    for(n=0; n<numOut; n++)
+    {
+      v      = &h[4*n+3+12];
+      out[n] = (T) (  b00*v[0] 
+                    + ( (b01*v[-1] + b02*v[-2])  +  (b03*v[-3]  + b04*v[-4]  ) )  
+                    + ( (b05*v[-5] + b06*v[-6])  +  (b07*v[-7]  + b08*v[-8]  ) )
+                    + ( (b09*v[-9] + b10*v[-10]) +  (b11*v[-11] + b12*v[-12] ) ) );
+    }
+
+    for(i=0; i<12; i++)
+      w[i] = h[numIn+11-i];
+    in            += numIn;
+    out           += numOut;
+    numOutSamples -= numOut;
+  }
+}
+
+template<class T>
+void EllipticQuarterBandFilter::decimate4(const T *in, T *out, int numOutSamples)
+{
+  switch( CpuDispatch::getInstructionSet() )
+  {
+  case CpuDispatch::AVX512: decimate4Avx512(in, out, numOutSamples); break;
+  case CpuDispatch::AVX2:   decimate4Avx2(  in, out, numOutSamples); break;
+  default:                  decimate4Kernel(in, out, numOutSamples);
+  }
+}
+
+template<class T>
+O303_TARGET_AVX2 void EllipticQuarterBandFilter::decimate4Avx2(const T *in, T *out,
+                                                               int numOutSamples)
+{
+  decimate4Kernel(in, out, numOutSamples);
+}
+
+template<class T>
+O303_TARGET_AVX512 void EllipticQuarterBandFilter::decimate4Avx512(const T *in, T *out,
+                                                                   int numOutSamples)
+{
+  decimate4Kernel(in, out, numOutSamples);
+}
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template void EllipticQuarterBandFilter::decimate4<double>(const double *in, double *out, 
+                                                           int numOutSamples);
+template void EllipticQuarterBandFilter::decimate4<float>(const float *in, float *out, 
+                                                          int numOutSamples);
+
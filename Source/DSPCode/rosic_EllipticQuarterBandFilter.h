@@ -5,6 +5,7 @@
 
 // rosic-indcludes:
 #include "GlobalDefinitions.h"
+#include "rosic_CpuDispatch.h"
 
 namespace rosic
 {
@@ -18,6 +19,8 @@ namespace rosic
   class EllipticQuarterBandFilter
   {
 
+    template<int numLanes> friend class Open303xN; // uses the coefficients and the state buffer
+
   public:
 
     //---------------------------------------------------------------------------------------------
@@ -38,10 +41,60 @@ namespace rosic
     /** Calculates a single filtered output-sample. */
     INLINE double getSample(double in);
 
+    /** The calculation of getSample on a state buffer that is passed in, with 'stride' values 
+    between its successive samples (numLanes for the interleaved states of Open303xN) - returns 
+    the output sample and writes the new state sample to 'newState', the caller shifts it into the 
+    buffer. */
+    template<int stride>
+    static INLINE double processSample(double in, const double *w, double &newState);
+
+    /** Filters 4*numOutSamples input samples and writes every 4th output sample (the last one of
+    each group of 4) - this is the same as calling getSample 4 times per output sample, but the 
+    non-recursive part of the filter is calculated only for the samples that are kept. */
+    template<class T>
+    void decimate4(const T *in, T *out, int numOutSamples);
+
     //=============================================================================================
 
   protected:
 
+    /** The implementation of decimate4 and its variants for the instruction sets, decimate4
+    dispatches to them (@see CpuDispatch). */
+    template<class T>
+    O303_KERNEL_INLINE void decimate4Kernel(const T *in, T *out, int numOutSamples);
+    template<class T>
+    O303_TARGET_AVX2 void decimate4Avx2(const T *in, T *out, int numOutSamples);
+    template<class T>
+    O303_TARGET_AVX512 void decimate4Avx512(const T *in, T *out, int numOutSamples);
+
+    // filter coefficients:
+    static constexpr double a01 =   -9.1891604652189471;
+    static constexpr double a02 =   40.177553696870497;
+    static constexpr double a03 = -110.11636661771178;
+    static constexpr double a04 =  210.18506612078195;
+    static constexpr double a05 = -293.84744771903240;
+    static constexpr double a06 =  308.16345558359234;
+    static constexpr double a07 = -244.06786780384243;
+    static constexpr double a08 =  144.81877911392738;
+    static constexpr double a09 =  -62.770692151724198;
+    static constexpr double a10 =   18.867762095902137;
+    static constexpr double a11 =   -3.5327094230551848;
+    static constexpr double a12 =    0.31183189275203149;
+
+    static constexpr double b00 =    0.00013671732099945628;
+    static constexpr double b01 =   -0.00055538501265606384;
+    static constexpr double b02 =    0.0013681887636296387;
+    static constexpr double b03 =   -0.0022158566490711852;
+    static constexpr double b04 =    0.0028320091007278322;
+    static constexpr double b05 =   -0.0029776933151090413;
+    static constexpr double b06 =    0.0030283628243514991;    
+    static constexpr double b07 =   -0.0029776933151090413;
+    static constexpr double b08 =    0.0028320091007278331;
+    static constexpr double b09 =   -0.0022158566490711861;
+    static constexpr double b10 =    0.0013681887636296393;    
+    static constexpr double b11 =   -0.00055538501265606384;
+    static constexpr double b12 =    0.00013671732099945636;
+
     // state buffer:
     double w[12];
 
@@ -52,49 +105,35 @@ namespace rosic
 
   INLINE double EllipticQuarterBandFilter::getSample(double in)
   {
-    const double a01 =   -9.1891604652189471;
-    const double a02 =   40.177553696870497;
-    const double a03 = -110.11636661771178;
-    const double a04 =  210.18506612078195;
-    const double a05 = -293.84744771903240;
-    const double a06 =  308.16345558359234;
-    const double a07 = -244.06786780384243;
-    const double a08 =  144.81877911392738;
-    const double a09 =  -62.770692151724198;
-    const double a10 =   18.867762095902137;
-    const double a11 =   -3.5327094230551848;
-    const double a12 =    0.31183189275203149;
-
-    const double b00 =    0.00013671732099945628;
-    const double b01 =   -0.00055538501265606384;
-    const double b02 =    0.0013681887636296387;
-    const double b03 =   -0.0022158566490711852;
-    const double b04 =    0.0028320091007278322;
-    const double b05 =   -0.0029776933151090413;
-    const double b06 =    0.0030283628243514991;    
-    const double b07 =   -0.0029776933151090413;
-    const double b08 =    0.0028320091007278331;
-    const double b09 =   -0.0022158566490711861;
-    const double b10 =    0.0013681887636296393;    
-    const double b11 =   -0.00055538501265606384;
-    const double b12 =    0.00013671732099945636;
+    double tmp;
+    double y = processSample<1>(in, w, tmp);
+
+    // update state variables:
+    memmove(&w[1], &w[0], 11*sizeof(double));
+    w[0] = tmp;
+
+    return y;
+  }
+
+  template<int stride>
+  INLINE double EllipticQuarterBandFilter::processSample(double in, const double *w, 
+                                                         double &newState)
+  {
+    const int s = stride;
 
     // calculate intermediate and output sample via direct form II - the parentheses facilitate 
     // out-of-order execution of the independent additions (for performance optimization):
     double tmp =   (in + TINY)
-                 - ( (a01*w[0] + a02*w[1] ) + (a03*w[2]  + a04*w[3]   ) ) 
-                 - ( (a05*w[4] + a06*w[5] ) + (a07*w[6]  + a08*w[7]   ) )
-                 - ( (a09*w[8] + a10*w[9] ) + (a11*w[10] +  a12*w[11] ) );
+                 - ( (a01*w[0]   + a02*w[1*s] ) + (a03*w[2*s]  + a04*w[3*s]   ) ) 
+                 - ( (a05*w[4*s] + a06*w[5*s] ) + (a07*w[6*s]  + a08*w[7*s]   ) )
+                 - ( (a09*w[8*s] + a10*w[9*s] ) + (a11*w[10*s] +  a12*w[11*s] ) );
    
     double y =     b00*tmp 
-                 + ( (b01*w[0] + b02*w[1])  +  (b03*w[2]  + b04*w[3]  ) )  
-                 + ( (b05*w[4] + b06*w[5])  +  (b07*w[6]  + b08*w[7]  ) )
-                 + ( (b09*w[8] + b10*w[9])  +  (b11*w[10] + b12*w[11] ) );
-
-    // update state variables:
-    memmove(&w[1], &w[0], 11*sizeof(double));
-    w[0] = tmp;
+                 + ( (b01*w[0]   + b02*w[1*s])  +  (b03*w[2*s]  + b04*w[3*s]  ) )  
+                 + ( (b05*w[4*s] + b06*w[5*s])  +  (b07*w[6*s]  + b08*w[7*s]  ) )
+                 + ( (b09*w[8*s] + b10*w[9*s])  +  (b11*w[10*s] + b12*w[11*s] ) );
 
+    newState = tmp;
     return y;
   }
 
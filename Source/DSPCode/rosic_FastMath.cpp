@@ -0,0 +1,3 @@
+#include "rosic_FastMath.h"
+using namespace rosic;
+
@@ -0,0 +1,148 @@
+#ifndef rosic_FastMath_h
+#define rosic_FastMath_h
+
+// standard library includes:
+#include <math.h>
+#include <string.h>
+
+// rosic includes:
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This file contains approximations of exp2, tanh and sin/cos for the per-sample code. They are
+  branch-free (the range reduction uses the rounding of the floating point addition instead of
+  floor and the quadrants are selected arithmetically), so loops that call them can be vectorized
+  (gcc needs -fno-trapping-math to if-convert the clipping, @see CMakeLists.txt).
+  The accuracy is a template parameter (@see mathAccuracies), so it is chosen at compile time for
+  each call site - for example: fastExp2<MATH_HIGH>(x).
+
+  The errors were measured against long double references over the stated ranges. The
+  approximations assume the default rounding mode and no -ffast-math (which would optimize the
+  rounding away).
+
+  */
+
+  /** Enumeration of the accuracy tiers. */
+  enum mathAccuracies
+  {
+    MATH_EXACT = 0, // the functions of the standard library (pow(2, x) for exp2)
+    MATH_HIGH,      // polynomial approximations with errors below 1e-10
+    MATH_FAST       // polynomial approximations with errors of about 1e-5...1e-4
+  };
+
+  /** Calculates 2^x. The relative error is below 5.6e-11 for MATH_HIGH and below 1.0e-4 for
+  MATH_FAST. x is clipped to -1022...1023. */
+  template<int accuracy>
+  INLINE double fastExp2(double x);
+
+  /** Calculates the hyperbolic tangent of x. The absolute error is below 3e-11 for MATH_HIGH and
+  below 5e-5 for MATH_FAST. */
+  template<int accuracy>
+  INLINE double fastTanh(double x);
+
+  /** Calculates sine and cosine of x. The absolute error is below 5e-11 for MATH_HIGH and below
+  1.2e-5 for MATH_FAST as long as |x| < 1e6 (above, the range reduction gets inaccurate). */
+  template<int accuracy>
+  INLINE void fastSinCos(double x, double* sinResult, double* cosResult);
+
+  //===============================================================================================
+  // implementation:
+
+  template<int accuracy>
+  INLINE double fastExp2(double x)
+  {
+    if( accuracy == MATH_EXACT )
+      return pow(2.0, x);
+
+    // split x into the integer n and the fraction f in -0.5...0.5 - adding 1.5*2^52 rounds x to
+    // an integer which then sits in the low bits of the mantissa:
+    const double magic = 6755399441055744.0;
+    x              = clip(x, -1022.0, 1023.0);
+    double shifted = x + magic;
+    double f       = x - (shifted - magic);
+
+    // 2^n is made by writing n into the exponent bits:
+    UINT64 bits;
+    memcpy(&bits, &shifted, sizeof(bits));
+    bits = (bits + 1023) << 52;
+    double scaler;
+    memcpy(&scaler, &bits, sizeof(scaler));
+
+    // 2^f by a polynomial (interpolating at the Chebyshev nodes):
+    double p;
+    if( accuracy == MATH_HIGH )
+    {
+      p = 0.99999999995956179  + f*(0.69314718055683244    + f*(0.24022651213498092
+        + f*(0.055504109063258679 + f*(0.0096180256133180184 + f*(0.0013333478473684449
+        + f*(0.00015469729214121424 + f*1.5303700711585945e-05))))));
+    }
+    else
+    {
+      p = 0.99992455695087079 + f*(0.69313673388362151 + f*(0.24263947854625853
+        + f*0.055838282946219855));
+    }
+    return scaler * p;
+  }
+
+  template<int accuracy>
+  INLINE double fastTanh(double x)
+  {
+    if( accuracy == MATH_EXACT )
+      return tanh(x);
+
+    // tanh(x) = (e^(2x)-1) / (e^(2x)+1), beyond +-20 tanh is +-1 in double precision:
+    x        = clip(x, -20.0, 20.0);
+    double e = fastExp2<accuracy>((2.0*ONE_OVER_LN2) * x);
+    return (e-1.0) / (e+1.0);
+  }
+
+  template<int accuracy>
+  INLINE void fastSinCos(double x, double* sinResult, double* cosResult)
+  {
+    if( accuracy == MATH_EXACT )
+    {
+      *sinResult = sin(x);
+      *cosResult = cos(x);
+      return;
+    }
+
+    // reduce x to r = x - q*pi/2 in -pi/4...pi/4 (rounding like in fastExp2), pi/2 is split into
+    // a part with 33 significant bits (such that q*pi/2 is exact) and the remainder:
+    const double magic = 6755399441055744.0;
+    double shifted = x*(2.0/PI) + magic;
+    double q       = shifted - magic;
+    double r       = (x - q*1.5707963267341256) - q*6.077100506506192e-11;
+    double r2      = r*r;
+
+    // sine and cosine of r by polynomials in r^2 (interpolating at the Chebyshev nodes):
+    double s, c;
+    if( accuracy == MATH_HIGH )
+    {
+      s = r*(0.99999999999567313 + r2*(-0.16666666631591165 + r2*(0.0083333287824588799
+        + r2*(-0.0001983920221223118 + r2*2.7173456841112996e-06))));
+      c = 0.99999999995248945 + r2*(-0.4999999961485761 + r2*(0.041666616692532826
+        + r2*(-0.0013886617999647178 + r2*2.4379831251184884e-05)));
+    }
+    else
+    {
+      s = r*(0.99999856326396042 + r2*(-0.16662472194586495 + r2*0.0081515063324659586));
+      c = 0.99998997978340887 + r2*(-0.49970742500618065 + r2*0.040397376384048014);
+    }
+
+    // rotate by q quarter periods (q modulo 4 is in the lowest bits of the mantissa):
+    UINT64 bits;
+    memcpy(&bits, &shifted, sizeof(bits));
+    int    quadrant = (int) (bits & 3);
+    double sq       = (quadrant & 1) ? c : s;
+    double cq       = (quadrant & 1) ? s : c;
+    *sinResult      = (quadrant & 2)     ? -sq : sq;
+    *cosResult      = ((quadrant+1) & 2) ? -cq : cq;
+  }
+
+} // end namespace rosic
+
+#endif // rosic_FastMath_h
@@ -0,0 +1,100 @@
+#include "rosic_HalfbandDecimator.h"
+#include "rosic_RealFunctions.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+template<class T>
+HalfbandDecimatorT<T>::HalfbandDecimatorT()
+{
+  numCoefficients = 0;
+  for(int i=0; i<maxNumCoefficients; i++)
+    coeffs[i] = 0.0;
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+template<class T>
+void HalfbandDecimatorT<T>::setCoefficients(int newNumCoefficients, double transitionBandwidth)
+{
+  numCoefficients = clip(newNumCoefficients, 1, maxNumCoefficients);
+
+  double k, q;
+  calculateTransitionParameters(transitionBandwidth, k, q);
+
+  // the poles of the elliptic halfband filter, mapped to the allpass coefficients:
+  int order = 2*numCoefficients + 1;
+  for(int c = 1; c <= numCoefficients; c++)
+  {
+    double num = 0.0, den = 0.0, term;
+    int    i   = 0;
+    do
+    {
+      term  = pow(q, (double) (i*(i+1))) * sin((2*i+1)*c*PI/order);
+      num  += (i % 2 == 0) ? term : -term;
+      i++;
+    } while( fabs(term) > 1.e-100 );
+    i = 1;
+    do
+    {
+      term  = pow(q, (double) (i*i)) * cos(2*i*c*PI/order);
+      den  += (i % 2 == 0) ? term : -term;
+      i++;
+    } while( fabs(term) > 1.e-100 );
+
+    double w  = num * pow(q, 0.25) / (den + 0.5);
+    double w2 = w*w;
+    double x  = sqrt((1.0-w2*k) * (1.0-w2/k)) / (1.0+w2);
+    coeffs[c-1] = (1.0-x) / (1.0+x);
+  }
+
+  reset();
+}
+
+template<class T>
+void HalfbandDecimatorT<T>::reset()
+{
+  for(int i=0; i<maxNumCoefficients; i++)
+  {
+    x1[i] = 0.0;
+    y1[i] = 0.0;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+template<class T>
+double HalfbandDecimatorT<T>::getStopbandAttenuation(int numCoefficients, 
+                                                      double transitionBandwidth)
+{
+  double k, q;
+  calculateTransitionParameters(transitionBandwidth, k, q);
+  int    order = 2*numCoefficients + 1;
+  double a     = 4.0 * pow(q, 0.5*order);
+  return 10.0 * log10(1.0 + 1.0/a);
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+template<class T>
+void HalfbandDecimatorT<T>::calculateTransitionParameters(double transitionBandwidth, double &k,
+                                                          double &q)
+{
+  k = tan((1.0-4.0*transitionBandwidth) * PI/4);
+  k = k*k;
+  double kk = pow(1.0-k*k, 0.25);
+  double e  = 0.5 * (1.0-kk) / (1.0+kk);
+  double e4 = e*e*e*e;
+  q = e * (1.0 + e4*(2.0 + e4*(15.0 + 150.0*e4)));
+}
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::HalfbandDecimatorT<double>;
+template class rosic::HalfbandDecimatorT<float>;
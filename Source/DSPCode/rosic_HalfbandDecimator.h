@@ -0,0 +1,115 @@
+#ifndef rosic_HalfbandDecimator_h
+#define rosic_HalfbandDecimator_h
+
+// rosic-indcludes:
+#include "GlobalDefinitions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a decimator by a factor of two based on a polyphase IIR halfband filter. The filter
+  consists of two parallel chains of first order allpass sections in z^-2 - the even input samples
+  go through the one chain, the odd samples through the other and the output is the average of the
+  two chains. Because the allpasses in z^-2 run at the decimated rate, only the output samples that
+  are actually kept get computed and the cost per output sample is one multiplication per
+  coefficient. The coefficients are designed for an elliptic magnitude response (equiripple in the
+  passband and stopband) from the desired number of coefficients and the transition bandwidth
+  (design formulas from Laurent de Soras' HIIR library). Cascading these decimators gives
+  decimation by powers of two. The template parameter is the type of the signal and the 
+  coefficients (float or double) - the allpass structure is robust against coefficient rounding, 
+  so the float version has the same stopband attenuation.
+
+  */
+
+  template<class T>
+  class HalfbandDecimatorT
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    HalfbandDecimatorT();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Designs the filter coefficients. The number of coefficients (at most maxNumCoefficients)
+    determines the order of the filter as 2*numCoefficients+1, the transition bandwidth is given as
+    fraction of the input sample rate (i.e. the passband extends up to 0.25-transitionBandwidth,
+    the stopband starts at 0.25+transitionBandwidth). */
+    void setCoefficients(int newNumCoefficients, double transitionBandwidth);
+
+    /** Resets the filter state. */
+    void reset();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the number of coefficients. */
+    int getNumCoefficients() const { return numCoefficients; }
+
+    /** Returns the stopband attenuation (in dB) that results from the given number of coefficients
+    and transition bandwidth. */
+    static double getStopbandAttenuation(int numCoefficients, double transitionBandwidth);
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Takes two successive input samples and returns one output sample. */
+    INLINE T getSample(T in0, T in1);
+
+    //=============================================================================================
+
+    static const int maxNumCoefficients = 12;
+
+  protected:
+
+    /** Calculates the elliptic modulus k and the nome q for the transition bandwidth. */
+    static void calculateTransitionParameters(double transitionBandwidth, double &k, double &q);
+
+    T   coeffs[maxNumCoefficients]; // allpass coefficients (even: 1st chain, odd: 2nd chain)
+    T   x1[maxNumCoefficients];     // previous inputs of the allpasses
+    T   y1[maxNumCoefficients];     // previous outputs of the allpasses
+    int numCoefficients;
+
+  };
+
+  //-----------------------------------------------------------------------------------------------
+  // inlined functions:
+
+  template<class T>
+  INLINE T HalfbandDecimatorT<T>::getSample(T in0, T in1)
+  {
+    T   a = in1;  // goes through the chain with the even coefficients
+    T   b = in0;  // goes through the chain with the odd coefficients
+    T   tmp;
+    int i;
+
+    for(i = 0; i < numCoefficients; i += 2)
+    {
+      tmp   = (a - y1[i]) * coeffs[i] + x1[i];
+      x1[i] = a;
+      y1[i] = tmp;
+      a     = tmp;
+    }
+    for(i = 1; i < numCoefficients; i += 2)
+    {
+      tmp   = (b - y1[i]) * coeffs[i] + x1[i];
+      x1[i] = b;
+      y1[i] = tmp;
+      b     = tmp;
+    }
+
+    return T(0.5) * (a + b);
+  }
+
+  typedef HalfbandDecimatorT<double> HalfbandDecimator;
+
+} // end namespace rosic
+
+#endif // rosic_HalfbandDecimator_h
@@ -1,7 +1,139 @@
 #include "rosic_MipMappedWaveTable.h"
+#include "rosic_FastMath.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <set>
+#include <thread>
+
 using namespace rosic;
 
-MipMappedWaveTable::MipMappedWaveTable()
+namespace rosic
+{
+
+  /**
+
+  The background thread that renders the mip-maps for MipMappedWaveTableT objects with 
+  asynchronous rendering switched on. It polls the objects for requests, hands the new mip-map 
+  over via their pendingMipMap slot and frees the ones that were swapped out by updateMipMap (in 
+  the retiredMipMap slot). Polling (instead of being notified) keeps the audio thread free of any
+  system calls. There's one such thread per sample type, it's started on first use.
+
+  */
+
+  template<class T>
+  class MipMapRenderThread
+  {
+
+  public:
+
+    typedef MipMappedWaveTableT<T>        Table;
+    typedef typename Table::MipMapKey     Key;
+    typedef typename Table::MipMapPointer Pointer;
+
+    /** Returns the (process-wide) instance. */
+    static MipMapRenderThread& getInstance()
+    {
+      static MipMapRenderThread instance;
+      return instance;
+    }
+
+    /** Starts serving the requests of the table. */
+    void add(Table *table)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      tables.insert(table);
+      wakeUp.notify_one();
+    }
+
+    /** Stops serving the requests of the table and waits until the table is not accessed by the 
+    thread anymore. */
+    void remove(Table *table)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [&]{ return busyTable != table; });
+      tables.erase(table);
+    }
+
+  protected:
+
+    MipMapRenderThread() : busyTable(nullptr), quit(false)
+    {
+      thread = std::thread(&MipMapRenderThread::run, this);
+    }
+
+    ~MipMapRenderThread()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+      }
+      wakeUp.notify_one();
+      thread.join();
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while( !quit )
+      {
+        if( tables.empty() )
+        {
+          wakeUp.wait(lock);
+          continue;
+        }
+
+        // tables can't be removed while being busy, so the iterator stays valid while unlocked:
+        for(auto it = tables.begin(); it != tables.end(); ++it)
+        {
+          Table *table = *it;
+          delete table->retiredMipMap.exchange(nullptr, std::memory_order_acquire);
+          if( (table->requestMiddle.load(std::memory_order_relaxed) & Table::newRequest) == 0 )
+            continue;
+
+          table->requestFront = 
+            table->requestMiddle.exchange(table->requestFront, std::memory_order_acq_rel) & 3;
+          Key key   = table->requestedKeys[table->requestFront];
+          busyTable = table;
+          lock.unlock();
+
+          Pointer *newMipMap = new Pointer(Table::createMipMap(key));
+          delete table->pendingMipMap.exchange(newMipMap, std::memory_order_acq_rel);
+
+          lock.lock();
+          busyTable = nullptr;
+          finished.notify_all();
+        }
+
+        wakeUp.wait_for(lock, std::chrono::milliseconds(pollingInterval));
+      }
+    }
+
+    static constexpr int pollingInterval = 10; // in milliseconds
+
+    std::set<Table*> tables;    // the tables with asynchronous rendering
+    Table*           busyTable; // the table whose request is currently processed
+    bool             quit;
+
+    std::mutex              mutex;
+    std::condition_variable wakeUp, finished;
+    std::thread             thread;
+
+  };
+
+}
+
+//-------------------------------------------------------------------------------------------------
+// static member variables:
+
+template<class T>
+std::mutex MipMappedWaveTableT<T>::cacheMutex;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+template<class T>
+MipMappedWaveTableT<T>::MipMappedWaveTableT()
 {
   // init member variables:
   sampleRate = 44100.0;
@@ -13,40 +145,52 @@ MipMappedWaveTable::MipMappedWaveTable()
   tanhShaperOffset = 4.37;
   squarePhaseShift = 180.0;
 
-  // set up the fourier-transformer:
-  fourierTransformer.setBlockSize(tableLength);
-
-  // initialize the buffers:
-  initPrototypeTable();
-  initTableSet();
+  // acquire the (all zeros) mip-map for the initial waveform:
+  tableSet      = nullptr;
+  requestBack   = 0;
+  requestFront  = 1;
+  requestMiddle = 2;
+  pendingMipMap = nullptr;
+  retiredMipMap = nullptr;
+  asynchronous  = false;
+  renderWaveform();
 }
 
-MipMappedWaveTable::~MipMappedWaveTable()
+template<class T>
+MipMappedWaveTableT<T>::~MipMappedWaveTableT()
 {
-
+  setAsynchronousRendering(false);
 }
 
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void MipMappedWaveTable::setWaveform(double* newWaveForm, int lengthInSamples)
+template<class T>
+void MipMappedWaveTableT<T>::setWaveform(double* newWaveForm, int lengthInSamples)
 {
-  int i;
-  if( lengthInSamples == tableLength )
+  if( lengthInSamples != tableLength )
+    return; // implement periodic sinc-interpolation here...
+
+  // make sure that an outstanding request doesn't overwrite the custom waveform later:
+  bool wasAsynchronous = asynchronous;
+  setAsynchronousRendering(false);
+
+  // custom waveforms are not cached - the mip-map is owned by this object alone:
+  std::shared_ptr<MipMap> newMipMap = std::make_shared<MipMap>();
   {
-    // just copy the values into the internal buffer, when the length of the passed table and the
-    // internal table match:
-    for( i=0; i<tableLength; i++ )
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    static double prototypeTable[tableLength];
+    for(int i=0; i<tableLength; i++)
       prototypeTable[i] = newWaveForm[i];
+    generateMipMap(prototypeTable, *newMipMap);
   }
-  else
-  {
-    // implement periodic sinc-interpolation here...
-  }
-  generateMipMap();
+  setMipMap(newMipMap);
+  currentKey = MipMapKey(-1, 0.0, 0.0, 0.0, 0.0); // matches no built-in waveform
+  setAsynchronousRendering(wasAsynchronous);
 }
 
-void MipMappedWaveTable::setWaveform(int newWaveform)
+template<class T>
+void MipMappedWaveTableT<T>::setWaveform(int newWaveform)
 {
   if( (newWaveform >= 0) && (newWaveform != waveform) )
   {
@@ -55,30 +199,52 @@ void MipMappedWaveTable::setWaveform(int newWaveform)
   }
 }
 
-void MipMappedWaveTable::setSymmetry(double newSymmetry)
+template<class T>
+void MipMappedWaveTableT<T>::setSymmetry(double newSymmetry)
 {
   symmetry = newSymmetry;
   renderWaveform();
 }
 
-//-------------------------------------------------------------------------------------------------
-// internal functions:
-
-void MipMappedWaveTable::initPrototypeTable()
+template<class T>
+void MipMappedWaveTableT<T>::setAsynchronousRendering(bool shouldBeAsynchronous)
 {
-  for(int i=0; i<(tableLength+4); i++)
-    prototypeTable[i] = 0.0;
-}
+  if( shouldBeAsynchronous == asynchronous )
+    return;
+  asynchronous = shouldBeAsynchronous;
 
-void MipMappedWaveTable::initTableSet()
-{
-  int t, i; // indices fo table and position
-  for(t=0; t<numTables; t++)
-    for(i=0; i<tableLength+4; i++)
-      tableSet[t][i] = 0.0;
+  if( asynchronous )
+  {
+    requestBack   = 0;
+    requestFront  = 1;
+    requestMiddle = 2;
+    MipMapRenderThread<T>::getInstance().add(this);
+  }
+  else
+  {
+    MipMapRenderThread<T>::getInstance().remove(this);
+    delete retiredMipMap.exchange(nullptr);
+    MipMapPointer *newMipMap = pendingMipMap.exchange(nullptr);
+    if( newMipMap != nullptr )
+    {
+      setMipMap(*newMipMap);
+      delete newMipMap;
+    }
+
+    // a request that has not been served yet is rendered now:
+    if( (requestMiddle.load() & newRequest) != 0 )
+    {
+      requestFront = requestMiddle.exchange(requestFront) & 3;
+      setMipMap(createMipMap(requestedKeys[requestFront]));
+    }
+  }
 }
 
-void MipMappedWaveTable::removeDC()
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+template<class T>
+void MipMappedWaveTableT<T>::removeDC(double *prototypeTable)
 {
   // calculate DC-offset (= average value of the table):
   double dcOffset = 0.0;
@@ -92,7 +258,8 @@ void MipMappedWaveTable::removeDC()
     prototypeTable[i] -= dcOffset;
 }
 
-void MipMappedWaveTable::normalize()
+template<class T>
+void MipMappedWaveTableT<T>::normalize(double *prototypeTable)
 {
   // find maximum:
   double max = 0.0;
@@ -107,7 +274,8 @@ void MipMappedWaveTable::normalize()
     prototypeTable[i] *= scale;
 }
 
-void MipMappedWaveTable::reverseTime()
+template<class T>
+void MipMappedWaveTableT<T>::reverseTime(double *prototypeTable)
 {
   int    i;
   double tmpTable[tableLength+4];
@@ -119,42 +287,106 @@ void MipMappedWaveTable::reverseTime()
     prototypeTable[i] = tmpTable[i];
 }
 
-void MipMappedWaveTable::renderWaveform()
+template<class T>
+typename MipMappedWaveTableT<T>::MipMapKey MipMappedWaveTableT<T>::getMipMapKey() const
+{
+  int w = waveform;
+  if( w < SILENCE || w > SAW303 )
+    w = SINE; // renderWaveform falls back to the sine
+  double sym  = (w == SQUARE || w == SAW) ? symmetry         : 0.0;
+  double fac  = (w == SQUARE303)          ? tanhShaperFactor : 0.0;
+  double off  = (w == SQUARE303)          ? tanhShaperOffset : 0.0;
+  double phs  = (w == SQUARE303)          ? squarePhaseShift : 0.0;
+  return MipMapKey(w, sym, fac, off, phs);
+}
+
+template<class T>
+void MipMappedWaveTableT<T>::renderWaveform()
+{
+  MipMapKey key = getMipMapKey();
+  if( mipMap != nullptr && key == currentKey )
+    return;
+  currentKey = key;
+
+  if( asynchronous )
+  {
+    requestedKeys[requestBack] = key;
+    requestBack = requestMiddle.exchange(requestBack | newRequest, std::memory_order_acq_rel) & 3;
+  }
+  else
+    setMipMap(createMipMap(key));
+}
+
+template<class T>
+typename MipMappedWaveTableT<T>::MipMapPointer 
+MipMappedWaveTableT<T>::createMipMap(const MipMapKey &key)
 {
-  switch( waveform )
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  // function-local, such that objects with static storage duration can use the cache safely:
+  static std::map<MipMapKey, std::weak_ptr<const MipMap>> cache;
+
+  MipMapPointer newMipMap = cache[key].lock();
+  if( newMipMap == nullptr )
   {
-  case   SINE:      fillWithSine();        break;
-  case   TRIANGLE:  fillWithTriangle();    break;
-  case   SQUARE:    fillWithSquare();      break;
-  case   SAW:       fillWithSaw();         break;
-  case   SQUARE303: fillWithSquare303();   break;
-  case   SAW303:    fillWithSaw303();      break;
-
-  default :  fillWithSine();
+    static double prototypeTable[tableLength];
+    switch( std::get<0>(key) )
+    {
+    case SILENCE:   fillWithZeros(prototypeTable);                                  break;
+    case SINE:      fillWithSine(prototypeTable);                                   break;
+    case TRIANGLE:  fillWithTriangle(prototypeTable);                               break;
+    case SQUARE:    fillWithSquare(prototypeTable, std::get<1>(key));               break;
+    case SAW:       fillWithSaw(prototypeTable, std::get<1>(key));                  break;
+    case SQUARE303: fillWithSquare303(prototypeTable, std::get<2>(key), std::get<3>(key), 
+                                      std::get<4>(key));                            break;
+    case SAW303:    fillWithSaw303(prototypeTable);                                 break;
+    }
+    std::shared_ptr<MipMap> tmp = std::make_shared<MipMap>();
+    generateMipMap(prototypeTable, *tmp);
+    newMipMap  = tmp;
+    cache[key] = newMipMap;
+
+    // clean up entries of mip-maps that are not used anymore:
+    for(auto it = cache.begin(); it != cache.end(); )
+    {
+      if( it->second.expired() )
+        it = cache.erase(it);
+      else
+        ++it;
+    }
   }
+  return newMipMap;
+}
+
+template<class T>
+void MipMappedWaveTableT<T>::setMipMap(MipMapPointer newMipMap)
+{
+  mipMap   = newMipMap;
+  tableSet = mipMap->tables;
 }
 
-void MipMappedWaveTable::generateMipMap()
+template<class T>
+void MipMappedWaveTableT<T>::generateMipMap(double *prototypeTable, MipMap &mipMap)
 {
+  static FourierTransformerRadix2 fourierTransformer;
   static double spectrum[tableLength];
-  //static int    position, offset;
-  static int t, i; // indices for the table and position
+  static double signal[tableLength];
+  T **tableSet = mipMap.tables;
+  int t, i; // indices for the table and position
 
-  //position = 0;             // begin of the 1st table (index 0)
-  //offset   = tableLength+4; // offset between tow tables, the 4 is the number
-  // of additional samples used for interpolation
+  fourierTransformer.setBlockSize(tableLength);
 
-  // copy the prototypeTable into the 1st table of the mipmap (this actually makes the
-  // prototypeTable redundant - room for optimization here):
+  // copy the prototypeTable into the 1st table of the mipmap:
   t = 0;
   for(i=0; i<tableLength; i++)
-    tableSet[0][i] = prototypeTable[i];
+    tableSet[0][i] = (T) prototypeTable[i];
 
   // additional sample(s) for the interpolator:
   tableSet[t][tableLength]   = tableSet[t][0];
   tableSet[t][tableLength+1] = tableSet[t][1];
   tableSet[t][tableLength+2] = tableSet[t][2];
   tableSet[t][tableLength+3] = tableSet[t][3];
+  tableSet[t][-1]            = tableSet[t][tableLength-1];
 
   // get the spectrum from the prototype-table:
   fourierTransformer.transformRealSignal(prototypeTable, spectrum);
@@ -177,28 +409,42 @@ void MipMappedWaveTable::generateMipMap()
       spectrum[i] = 0.0;
 
     // transform the truncated spectrum back to the time-domain and store it in
-    // the tableSet
-    fourierTransformer.transformSymmetricSpectrum(spectrum, tableSet[t]);
+    // the tableSet - shorter tables take every n-th sample, which is exact because the spectrum 
+    // is zero above their Nyquist frequency:
+    fourierTransformer.transformSymmetricSpectrum(spectrum, signal);
+    int length = getTableLength(t);
+    int step   = tableLength / length;
+    for(i=0; i<length; i++)
+      tableSet[t][i] = (T) signal[i*step];
 
     // additional sample(s) for the interpolator:
-    tableSet[t][tableLength]   = tableSet[t][0];
-    tableSet[t][tableLength+1] = tableSet[t][1];
-    tableSet[t][tableLength+2] = tableSet[t][2];
-    tableSet[t][tableLength+3] = tableSet[t][3];
+    tableSet[t][length]   = tableSet[t][0];
+    tableSet[t][length+1] = tableSet[t][1];
+    tableSet[t][length+2] = tableSet[t][2];
+    tableSet[t][length+3] = tableSet[t][3];
+    tableSet[t][-1]       = tableSet[t][length-1];
   }
 }
 
 //-------------------------------------------------------------------------------------------------
 // fill the prototype-table with various standard waveforms:
 
-void MipMappedWaveTable::fillWithSine()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithZeros(double *prototypeTable)
+{
+  for(int i=0; i<tableLength; i++)
+    prototypeTable[i] = 0.0;
+}
+
+template<class T>
+void MipMappedWaveTableT<T>::fillWithSine(double *prototypeTable)
 {
   for (int i=0; i<tableLength; i++)
     prototypeTable[i] = sin( (2.0*PI*i) / (double) (tableLength) );
-  generateMipMap();
 }
 
-void MipMappedWaveTable::fillWithTriangle()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithTriangle(double *prototypeTable)
 {
   int i;
   for (i=0; i<(tableLength/4); i++)
@@ -209,11 +455,10 @@ void MipMappedWaveTable::fillWithTriangle()
 
   for (i=(3*tableLength/4); i<(tableLength); i++)
     prototypeTable[i] = -4.0+ ((double)(4*i) / (double)(tableLength));
-
-  generateMipMap();
 }
 
-void MipMappedWaveTable::fillWithSquare()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithSquare(double *prototypeTable, double symmetry)
 {
   int    N  = tableLength;
   double k  = symmetry;
@@ -222,11 +467,10 @@ void MipMappedWaveTable::fillWithSquare()
     prototypeTable[n] = +1.0;
   for(int n=N1; n<N; n++)
     prototypeTable[n] = -1.0;
-
-  generateMipMap();
 }
 
-void MipMappedWaveTable::fillWithSaw()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithSaw(double *prototypeTable, double symmetry)
 {
   int    N  = tableLength;
   double k  = symmetry;
@@ -238,11 +482,11 @@ void MipMappedWaveTable::fillWithSaw()
     prototypeTable[n] = s1*n;
   for(int n=N1; n<N; n++)
     prototypeTable[n] = -1.0 + s2*(n-N1);
-
-  generateMipMap();
 }
 
-void MipMappedWaveTable::fillWithSquare303()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithSquare303(double *prototypeTable, double tanhShaperFactor,
+                                               double tanhShaperOffset, double squarePhaseShift)
 {
   // generate the saw-wave:
   int    N  = tableLength;
@@ -258,16 +502,15 @@ void MipMappedWaveTable::fillWithSquare303()
 
   // switch polarity and apply tanh-shaping with dc-offset:
   for(int n=0; n<N; n++)
-    prototypeTable[n] = -tanh(tanhShaperFactor*prototypeTable[n] + tanhShaperOffset);
+    prototypeTable[n] = -fastTanh<MATH_HIGH>(tanhShaperFactor*prototypeTable[n] + tanhShaperOffset);
 
   // do a circular shift to phase-align with the saw-wave, when both waveforms are mixed:
   int nShift = roundToInt(N*squarePhaseShift/360.0);
   circularShift(prototypeTable, N, nShift);
-
-  generateMipMap();
 }
 
-void MipMappedWaveTable::fillWithSaw303()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithSaw303(double *prototypeTable)
 {
   // generate the saw-wave:
   int    N  = tableLength;
@@ -284,11 +527,10 @@ void MipMappedWaveTable::fillWithSaw303()
   // switch polarity:
   //for(int n=0; n<N; n++)
   //  prototypeTable[n] = -prototypeTable[n];
-
-  generateMipMap();
 }
 
-void MipMappedWaveTable::fillWithPeak()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithPeak(double *prototypeTable)
 {
   int i;
   for (i=0; i<(tableLength/2); i++)
@@ -297,13 +539,12 @@ void MipMappedWaveTable::fillWithPeak()
   for (i=(tableLength/2); i<(tableLength); i++)
     prototypeTable[i] = 0.0;
 
-  removeDC();
-  normalize();
-
-  generateMipMap();
+  removeDC(prototypeTable);
+  normalize(prototypeTable);
 }
 
-void MipMappedWaveTable::fillWithMoogSaw()
+template<class T>
+void MipMappedWaveTableT<T>::fillWithMoogSaw(double *prototypeTable)
 {
   // the sawUp part:
   int i;
@@ -320,21 +561,12 @@ void MipMappedWaveTable::fillWithMoogSaw()
   for (i=(tableLength/2); i<tableLength; i++)
     prototypeTable[i] += -1 + (double)(4*i) / (double)(tableLength);
 
-  removeDC();
-  normalize();
-
-  generateMipMap();
+  removeDC(prototypeTable);
+  normalize(prototypeTable);
 }
 
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
 
-
-
-
-
-
-
-
-
-
-
-
+template class rosic::MipMappedWaveTableT<double>;
+template class rosic::MipMappedWaveTableT<float>;
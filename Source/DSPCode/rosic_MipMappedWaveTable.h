@@ -1,6 +1,14 @@
 #ifndef rosic_MipMappedWaveTable_h
 #define rosic_MipMappedWaveTable_h
 
+// standard-library includes:
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
 // rosic-indcludes:
 #include "rosic_FunctionTemplates.h"
 #include "rosic_FourierTransformerRadix2.h"
@@ -8,21 +16,38 @@
 namespace rosic
 {
 
+  template<class T> class MipMapRenderThread;
+
   /**
 
   This is a class for generating and storing a single-cycle-waveform in a lookup-table and 
-  retrieving values form it at arbitrary positions by means of interpolation.
+  retrieving values form it at arbitrary positions by means of interpolation. The template 
+  parameter is the type of the stored tables (float or double) - the waveforms are always rendered
+  in double precision.
+
+  The rendered tables (the mip-map) are immutable and shared between all objects that use the same 
+  waveform parameters by means of a process-wide cache. The cache holds no ownership, so a mip-map 
+  is freed when the last object that uses it switches to another one or is destroyed. The cache is 
+  thread-safe, the objects themselves are not.
+
+  With asynchronous rendering switched on, the parameter setters don't render the mip-map 
+  themselves but pass the request to a background thread. The new mip-map is then swapped in on 
+  the audio thread by updateMipMap(). Neither the setters nor updateMipMap() block, allocate or 
+  free memory in this mode - until the swap, the previous waveform continues to play.
 
   */
 
-  class MipMappedWaveTable
+  template<class T>
+  class MipMappedWaveTableT
   {
 
     // Oscillator and SuperOscillator classes need access to certain protected member-variables 
     // (namely the tableLength and related quantities), so we declare them as friend-classes:
     friend class Oscillator;
-    friend class BlendOscillator;
+    template<class> friend class BlendOscillatorT;
     friend class SuperOscillator;
+    template<int numLanes> friend class Open303xN;
+    friend class MipMapRenderThread<T>;
     // \ todo: get rid of this by providing get-functions
 
   public:
@@ -42,10 +67,10 @@ namespace rosic
     // construction/destruction:
 
     /** Constructor. */
-    MipMappedWaveTable();          
+    MipMappedWaveTableT();          
 
     /** Destructor. */
-    ~MipMappedWaveTable();         
+    ~MipMappedWaveTableT();         
 
     //---------------------------------------------------------------------------------------------
     // parmeter-settings:
@@ -73,17 +98,23 @@ namespace rosic
     /** Sets the drive (in dB) for the tanh-shaper for 303-square waveform - internal parameter, to 
     be scrapped eventually. */
     void setTanhShaperDriveFor303Square(double newDrive)
-    { tanhShaperFactor = dB2amp(newDrive); fillWithSquare303(); }
+    { tanhShaperFactor = dB2amp(newDrive); renderWaveform(); }
 
     /** Sets the offset (as raw value for the tanh-shaper for 303-square waveform - internal 
     parameter, to be scrapped eventually. */
     void setTanhShaperOffsetFor303Square(double newOffset)
-    { tanhShaperOffset = newOffset; fillWithSquare303(); }
+    { tanhShaperOffset = newOffset; renderWaveform(); }
 
     /** Sets the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
     void set303SquarePhaseShift(double newShift)
-    { squarePhaseShift = newShift; fillWithSquare303(); }
+    { squarePhaseShift = newShift; renderWaveform(); }
+
+    /** Switches asynchronous rendering of the mip-maps on or off. When it's on, waveform changes
+    take effect in the first call to updateMipMap() after the background thread has rendered the 
+    new mip-map. Switch it on when the parameters are set on the audio thread (but don't call this
+    function itself on the audio thread). */
+    void setAsynchronousRendering(bool shouldBeAsynchronous);
 
     //---------------------------------------------------------------------------------------------
     // inquiry:
@@ -100,110 +131,216 @@ namespace rosic
     - this is important when the two are mixed. */
     double get303SquarePhaseShift() const { return squarePhaseShift; }
 
+    /** Returns true when asynchronous rendering of the mip-maps is switched on. */
+    bool isRenderingAsynchronously() const { return asynchronous; }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Returns the value at position 'integerPart+fractionalPart' of table 'tableIndex' with 
     linear interpolation - this function may be preferred over 
     getValueLinear(double phaseIndex, int tableIndex) when you want to calculate the integer and 
-    fractional part of the phase-index yourself. */
-    INLINE double getValueLinear(int integerPart, double fractionalPart, int tableIndex);
+    fractional part of the phase-index yourself. The position is in samples of that table, i.e. 
+    in the range 0...getTableLength(tableIndex) (@see getIndexScale). */
+    INLINE T getValueLinear(int integerPart, T fractionalPart, int tableIndex);
 
     /** Returns the value at position 'phaseIndex' of table 'tableIndex' with linear 
     interpolation - this function computes the integer and fractional part of the phaseIndex
     internally. */
-    INLINE double getValueLinear(double phaseIndex, int tableIndex);
+    INLINE T getValueLinear(double phaseIndex, int tableIndex);
 
-  protected:
+    /** Calculates the weights of the samples at integerPart-1...integerPart+2 for the 
+    interpolation of table 'tableIndex' at position 'integerPart+fractionalPart' - linear for the 
+    full-length tables, cubic (Catmull-Rom) for the shortened ones (@see numFullLengthTables). */
+    static INLINE void getWeights(T fractionalPart, int tableIndex, T *weights);
 
-    // functions to fill table with the built-in waveforms (these functions are
-    // called from setWaveform(int newWaveform):
-    void fillWithSine();
-    void fillWithTriangle();
-    void fillWithSquare();
-    void fillWithSaw();
-    void fillWithSquare303();
-    void fillWithSaw303();
-    void fillWithPeak();
-    void fillWithMoogSaw();
+    /** Returns the value at position 'integerPart+fractionalPart' of table 'tableIndex' with the 
+    weights from getWeights - this is what the oscillators use. The weights can be shared by 
+    tables with the same length. */
+    INLINE T getValue(int integerPart, const T *weights, int tableIndex);
 
-    void initPrototypeTable();
-      // fills the "prototypeTable"-variable with all zeros
+    /** Swaps in a mip-map that has been rendered asynchronously, if any - call this on the audio
+    thread once per block. It's wait-free and the replaced mip-map is freed by the background 
+    thread. */
+    INLINE void updateMipMap();
 
-    void initTableSet();
-      // fills the "tableSet"-variable with all zeros
+  protected:
 
-    void removeDC();
+    static const int tableLength = 2048;
+      // Length of the full-bandwidth lookup-table (the one of the prototype waveform). The phase 
+      // of the oscillators runs in units of this length. Each table is followed by 4 additional 
+      // samples for the interpolator (which are the same values as at the beginning of the table)
+      // and preceded by 1 (the same value as at the end of the table)
+
+    static const int numTables = 12;
+      // The Oscillator class uses a one table-per octave multisampling to avoid aliasing. With a 
+      // table-size of 8192 and a sample-sample rate of  44100, the 12th table will have a 
+      // fundamental frequency (the frequency where the increment is 1) of 11025 which is good for 
+      // the highest frequency. 
+
+    static constexpr int numFullLengthTables = 6;
+    static constexpr int minTableLength      = 64;
+      // The first tables are stored with the full tableLength, each following one has half the 
+      // length of its predecessor (down to minTableLength) because it has half the bandwidth. That
+      // keeps the highest harmonic of every table at 64 or more samples per cycle (as in table 5). 
+      // The shortened tables are read with cubic instead of linear interpolation, which keeps the 
+      // images of the interpolation below the ones of the full-length tables with linear 
+      // interpolation. The tables up to 5 cover the notes up to about 340 Hz at 1x oversampling 
+      // (and an octave higher per doubling of the factor).
+
+    static constexpr int alignment = 64 / sizeof(T);
+      // the tables start at multiples of 64 bytes (cache lines)
+
+    /** Returns the number of samples in table 'tableIndex' (without the additional samples). */
+    static constexpr int getTableLength(int tableIndex)
+    {
+      return std::max(tableLength >> std::max(tableIndex-numFullLengthTables+1, 0), 
+                      minTableLength);
+    }
+
+    /** Returns the position of table 'tableIndex' within the samples of the mip-map (also valid 
+    for tableIndex == numTables, where it returns the total length). The first table starts after
+    one alignment unit, such that each table has room for its preceding sample. */
+    static constexpr int getTableOffset(int tableIndex)
+    {
+      int offset = alignment;
+      for(int t = 0; t < tableIndex; t++)
+        offset += (getTableLength(t)+4 + alignment-1) / alignment * alignment;
+      return offset;
+    }
+
+    /** Returns the factor that converts a phase in units of the tableLength into a position in
+    table 'tableIndex' - it's a power of two, so the conversion is exact. */
+    static INLINE double getIndexScale(int tableIndex)
+    {
+      return getTableLength(tableIndex) * (1.0/tableLength);
+    }
+
+    /** Interpolates the table at position integerPart with the weights (@see getValue) - shared 
+    with the lanes of Open303xN. */
+    static INLINE T interpolate(const T *table, int integerPart, const T *weights);
+
+    /** The multisample for anti-aliased waveform generation - defined below the class. */
+    struct MipMap;
+
+    /** The parameters that determine the content of a mip-map (waveform, symmetry, tanh-shaper 
+    factor and offset, square phase shift) - parameters that have no effect on the waveform are set
+    to zero such that the mip-map can be shared with more objects. */
+    typedef std::tuple<int, double, double, double, double> MipMapKey;
+
+    typedef std::shared_ptr<const MipMap> MipMapPointer;
+
+    // functions to fill the prototype table with the built-in waveforms (these functions are
+    // called from createMipMap):
+    static void fillWithZeros(double *prototypeTable);
+    static void fillWithSine(double *prototypeTable);
+    static void fillWithTriangle(double *prototypeTable);
+    static void fillWithSquare(double *prototypeTable, double symmetry);
+    static void fillWithSaw(double *prototypeTable, double symmetry);
+    static void fillWithSquare303(double *prototypeTable, double tanhShaperFactor, 
+                                  double tanhShaperOffset, double squarePhaseShift);
+    static void fillWithSaw303(double *prototypeTable);
+    static void fillWithPeak(double *prototypeTable);
+    static void fillWithMoogSaw(double *prototypeTable);
+
+    static void removeDC(double *prototypeTable);
       // removes dc-component from the waveform in the prototype-table
 
-    void normalize();
+    static void normalize(double *prototypeTable);
       // normalizes the amplitude of the prototype-table to 1.0
 
-    void reverseTime();
+    static void reverseTime(double *prototypeTable);
       // time-reverses the prototype-table
 
-    /** Renders the prototype waveform and generates the mip-map from that. */
+    /** Returns the key for the mip-map of the current waveform parameters. */
+    MipMapKey getMipMapKey() const;
+
+    /** Switches to the mip-map for the current waveform parameters - or, with asynchronous 
+    rendering, requests it from the background thread. */
     void renderWaveform();
 
-    void generateMipMap();
-      // generates a multisample from the prototype table, where each of the
-      // successive tables contains one half of the spectrum of the previous one
+    /** Takes the mip-map for the passed key from the cache or renders the prototype waveform and 
+    generates the mip-map from that, when there is none. */
+    static MipMapPointer createMipMap(const MipMapKey &key);
 
-    static const int tableLength = 2048;
-      // Length of the lookup-table. The actual length of the allocated memory is 4 samples longer, 
-      // to store additional samples for the interpolator (which are the same values as at the 
-      // beginning of the buffer) */
+    /** Switches to the passed mip-map. */
+    void setMipMap(MipMapPointer newMipMap);
 
 
-    double symmetry; // symmetry between 1st and 2nd half-wave
+    static void generateMipMap(double *prototypeTable, MipMap &mipMap);
+      // generates a multisample from the prototype table, where each of the
+      // successive tables contains one half of the spectrum of the previous one - must be called 
+      // with the cacheMutex locked because it uses static buffers
 
-    static const int numTables = 12;
-      // The Oscillator class uses a one table-per octave multisampling to avoid aliasing. With a 
-      // table-size of 8192 and a sample-sample rate of  44100, the 12th table will have a 
-      // fundamental frequency (the frequency where the increment is 1) of 11025 which is good for 
-      // the highest frequency. 
+    double symmetry; // symmetry between 1st and 2nd half-wave
 
     int    waveform;   // index of the currently chosen native waveform
     double sampleRate; // the sampleRate
 
-    double prototypeTable[tableLength];
-      // this is the prototype-table with full bandwidth. one additional sample (same as 
-      // prototypeTable[0]) for linear interpolation without need for table wraparound at the last 
-      // sample (-> saves one if-statement each audio-cycle) ...and a three further addtional 
-      // samples for more elaborate interpolations like cubic (not implemented yet, also:
-      // the fillWith...()-functions don't support these samples yet). */
-
-    double tableSet[numTables][tableLength+4];
-      // The multisample for anti-aliased waveform generation. The 4 additional values are equal 
-      // to the first 4 values in the table for easier interpolation. The first index is for the 
-      // table-number - index 0 accesses the first version which has full bandwidth, index 1 
-      // accesses the second version which is bandlimited to Nyquist/2, 2->Nyquist/4, 
-      // 3->Nyquist/8, etc. */
-
-    // embedded objects:
-    FourierTransformerRadix2 fourierTransformer;
+    MipMapPointer mipMap;                   // the (shared) mip-map in use
+    MipMapKey currentKey;                   // the key of the mip-map in use (or requested)
+    const T* const *tableSet;               // the tables of the mip-map for fast access
+
+    // hand-over between the background thread and the audio thread for asynchronous rendering - 
+    // the requests are passed through a triple buffer, the index of the middle buffer has the 
+    // newRequest flag set when it has not yet been taken by the background thread:
+    static const int newRequest = 4;
+    MipMapKey requestedKeys[3];
+    int requestBack, requestFront;             // owned by the setters and the background thread
+    std::atomic<int> requestMiddle;            // exchanged between the two
+    std::atomic<MipMapPointer*> pendingMipMap; // rendered, to be swapped in by updateMipMap
+    std::atomic<MipMapPointer*> retiredMipMap; // swapped out, to be freed by the background thread
+    bool asynchronous;                         // flag to indicate asynchronous rendering
 
     // internal parameters:
     double tanhShaperFactor, tanhShaperOffset, squarePhaseShift;
 
+    // guards the process-wide cache of the rendered mip-maps (see renderWaveform) and the static 
+    // buffers used for rendering:
+    static std::mutex cacheMutex;
+
+  };
+
+  /** The multisample for anti-aliased waveform generation. The tables are stored one after 
+  another in a single buffer. The first index of tables is for the table-number - index 0 
+  accesses the first version which has full bandwidth, index 1 accesses the second version which 
+  is bandlimited to Nyquist/2, 2->Nyquist/4, 3->Nyquist/8, etc. Table t contains 
+  getTableLength(t) samples plus 4 additional values which are equal to the first 4 values in the 
+  table and is preceded by the last value of the table for easier interpolation. */
+  template<class T>
+  struct alignas(64) MipMappedWaveTableT<T>::MipMap
+  {
+    MipMap()
+    {
+      for(int t = 0; t < numTables; t++)
+        tables[t] = samples + getTableOffset(t);
+    }
+
+    MipMap(const MipMap&) = delete;
+    MipMap& operator=(const MipMap&) = delete;
+
+    T samples[getTableOffset(numTables)];
+    T *tables[numTables];
   };
 
   //-----------------------------------------------------------------------------------------------
   // inlined functions:
     
-  INLINE double MipMappedWaveTable::getValueLinear(int integerPart, double fractionalPart, int tableIndex)
+  template<class T>
+  INLINE T MipMappedWaveTableT<T>::getValueLinear(int integerPart, T fractionalPart, int tableIndex)
   {
     // ensure, that the table index is in the valid range:
     if( tableIndex<=0 )
       tableIndex = 0;
-    else if ( tableIndex>numTables )
-      tableIndex = 11;
+    else if ( tableIndex>=numTables )
+      tableIndex = numTables-1;
 
-    return   (1.0-fractionalPart) * tableSet[tableIndex][integerPart] 
-           +      fractionalPart  * tableSet[tableIndex][integerPart+1];
+    return   (T(1)-fractionalPart) * tableSet[tableIndex][integerPart] 
+           +       fractionalPart  * tableSet[tableIndex][integerPart+1];
   }
 
-  INLINE double MipMappedWaveTable::getValueLinear(double phaseIndex, int tableIndex)
+  template<class T>
+  INLINE T MipMappedWaveTableT<T>::getValueLinear(double phaseIndex, int tableIndex)
   {
     /*
     // ensure, that the table index is in the valid range:
@@ -215,13 +352,70 @@ namespace rosic
 
     // calculate integer and fractional part of the phaseIndex:
     int    intIndex = floorInt(phaseIndex);
-    double frac     = phaseIndex  - (double) intIndex;
+    T      frac     = (T) (phaseIndex - (double) intIndex);
     return getValueLinear(intIndex, frac, tableIndex);
 
     // lookup value in the table with linear interpolation and return it:
     //return (1.0-frac)*tableSet[tableIndex][intIndex] + frac*tableSet[tableIndex][intIndex+1];
   }
 
+  template<class T>
+  INLINE void MipMappedWaveTableT<T>::getWeights(T fractionalPart, int tableIndex, T *weights)
+  {
+    const T f = fractionalPart;
+    if( tableIndex < numFullLengthTables )
+    {
+      weights[0] = T(0);
+      weights[1] = T(1)-f;
+      weights[2] = f;
+      weights[3] = T(0);
+    }
+    else
+    {
+      weights[0] = ((T(-0.5)*f + T(1))*f - T(0.5))*f;
+      weights[1] = (T(1.5)*f - T(2.5))*f*f + T(1);
+      weights[2] = ((T(-1.5)*f + T(2))*f + T(0.5))*f;
+      weights[3] = (T(0.5)*f - T(0.5))*f*f;
+    }
+  }
+
+  template<class T>
+  INLINE T MipMappedWaveTableT<T>::interpolate(const T *table, int integerPart, const T *weights)
+  {
+    // for linear interpolation, the outer weights are zero and the result is the same as with 
+    // (1-f)*x[0] + f*x[1]:
+    const T *x = table + integerPart;
+    return (weights[1]*x[0] + weights[2]*x[1]) + (weights[0]*x[-1] + weights[3]*x[2]);
+  }
+
+  template<class T>
+  INLINE T MipMappedWaveTableT<T>::getValue(int integerPart, const T *weights, int tableIndex)
+  {
+    if( tableIndex<=0 )
+      tableIndex = 0;
+    else if ( tableIndex>=numTables )
+      tableIndex = numTables-1;
+    return interpolate(tableSet[tableIndex], integerPart, weights);
+  }
+
+  template<class T>
+  INLINE void MipMappedWaveTableT<T>::updateMipMap()
+  {
+    // the retired slot must have been emptied by the background thread before we can swap again:
+    if(    pendingMipMap.load(std::memory_order_relaxed) == nullptr 
+        || retiredMipMap.load(std::memory_order_relaxed) != nullptr )
+      return;
+
+    MipMapPointer *newMipMap = pendingMipMap.exchange(nullptr, std::memory_order_acquire);
+    if( newMipMap == nullptr )
+      return;
+    mipMap.swap(*newMipMap); // no reference counting here, *newMipMap now holds the old one
+    tableSet = mipMap->tables;
+    retiredMipMap.store(newMipMap, std::memory_order_release);
+  }
+
+  typedef MipMappedWaveTableT<double> MipMappedWaveTable;
+
 } // end namespace rosic
 
 #endif // rosic_MipMappedWaveTable_h
@@ -0,0 +1,95 @@
+#include "rosic_NoteStack.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+NoteStack::NoteStack()
+{
+  priority = LAST_NOTE;
+  numNotes = 0;
+  newest   = -1;
+  for(int k = 0; k < numKeys; k++)
+  {
+    older[k]      = -1;
+    newer[k]      = -1;
+    velocities[k] = 0;
+    held[k]       = false;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void NoteStack::setNotePriority(int newPriority)
+{
+  if( newPriority >= 0 && newPriority < NUM_NOTE_PRIORITIES )
+    priority = newPriority;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+int NoteStack::getSoundingKey() const
+{
+  if( numNotes == 0 )
+    return -1;
+
+  int k;
+  switch( priority )
+  {
+  case HIGHEST_NOTE:
+    for(k = numKeys-1; !held[k]; k--);
+    return k;
+  case LOWEST_NOTE:
+    for(k = 0; !held[k]; k++);
+    return k;
+  default:
+    return newest;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// manipulation:
+
+void NoteStack::push(int key, int velocity)
+{
+  if( key < 0 || key >= numKeys )
+    return;
+
+  remove(key);
+  older[key]      = newest;
+  newer[key]      = -1;
+  velocities[key] = velocity;
+  held[key]       = true;
+  if( newest != -1 )
+    newer[newest] = key;
+  newest = key;
+  numNotes++;
+}
+
+void NoteStack::remove(int key)
+{
+  if( !isHeld(key) )
+    return;
+
+  // unlink the key from its neighbours:
+  if( older[key] != -1 )
+    newer[older[key]] = newer[key];
+  if( newer[key] != -1 )
+    older[newer[key]] = older[key];
+  else
+    newest = older[key];
+
+  older[key]      = -1;
+  newer[key]      = -1;
+  velocities[key] = 0;
+  held[key]       = false;
+  numNotes--;
+}
+
+void NoteStack::clear()
+{
+  while( newest != -1 )
+    remove(newest);
+}
@@ -0,0 +1,98 @@
+#ifndef rosic_NoteStack_h
+#define rosic_NoteStack_h
+
+namespace rosic
+{
+
+  /**
+
+  This is a stack of the currently held MIDI notes for monophonic instruments, which decides which
+  of the held notes sounds (according to the note priority). It has a fixed capacity of one entry
+  per key and never allocates memory, so it can be used on the audio thread. The held notes are
+  kept in a doubly linked list in the order in which they were pressed, which is indexed by the
+  key - so pushing and removing a note is O(1). Finding the sounding note is O(1) for LAST_NOTE and
+  scans the keys for HIGHEST_NOTE and LOWEST_NOTE.
+
+  */
+
+  class NoteStack
+  {
+
+  public:
+
+    /** Enumeration of the note priorities. */
+    enum notePriorities
+    {
+      LAST_NOTE = 0,  // the most recently pressed note sounds
+      HIGHEST_NOTE,   // the highest held note sounds
+      LOWEST_NOTE,    // the lowest held note sounds
+
+      NUM_NOTE_PRIORITIES
+    };
+
+    static const int numKeys = 128;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    NoteStack();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Selects which of the held notes sounds (@see notePriorities). */
+    void setNotePriority(int newPriority);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the note priority (@see notePriorities). */
+    int getNotePriority() const { return priority; }
+
+    /** Returns true when no note is held. */
+    bool isEmpty() const { return numNotes == 0; }
+
+    /** Returns the number of held notes. */
+    int getNumNotes() const { return numNotes; }
+
+    /** Returns true when the key is held. */
+    bool isHeld(int key) const { return key >= 0 && key < numKeys && held[key]; }
+
+    /** Returns the velocity with which a held key was pressed (0 if it is not held). */
+    int getVelocity(int key) const { return isHeld(key) ? velocities[key] : 0; }
+
+    /** Returns the key of the note that sounds according to the note priority or -1 when no note
+    is held. */
+    int getSoundingKey() const;
+
+    //---------------------------------------------------------------------------------------------
+    // manipulation:
+
+    /** Adds a note on top of the stack. When the key is held already, it is moved to the top and
+    gets the new velocity. Keys outside 0...127 are ignored. */
+    void push(int key, int velocity);
+
+    /** Removes a note from the stack (if it is held). */
+    void remove(int key);
+
+    /** Removes all notes. */
+    void clear();
+
+    //=============================================================================================
+
+  protected:
+
+    int  priority;             // the selected note priority
+    int  numNotes;             // number of held notes
+    int  newest;               // the most recently pressed key (-1 if none)
+    int  older[numKeys];       // the key that was pressed before a held key (-1 for the oldest)
+    int  newer[numKeys];       // the key that was pressed after a held key (-1 for the newest)
+    int  velocities[numKeys];  // the velocities of the held keys
+    bool held[numKeys];        // flags for the held keys
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_NoteStack_h
@@ -4,7 +4,8 @@ using namespace rosic;
 //-------------------------------------------------------------------------------------------------
 // construction/destruction:
 
-OnePoleFilter::OnePoleFilter()
+template<class T>
+OnePoleFilterT<T>::OnePoleFilterT()
 {
   shelvingGain = 1.0;
   setSampleRate(44100.0);  // sampleRate = 44100 Hz by default
@@ -16,7 +17,8 @@ OnePoleFilter::OnePoleFilter()
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void OnePoleFilter::setSampleRate(double newSampleRate)
+template<class T>
+void OnePoleFilterT<T>::setSampleRate(double newSampleRate)
 {
   if( newSampleRate > 0.0 )
     sampleRate = newSampleRate;
@@ -26,13 +28,15 @@ void OnePoleFilter::setSampleRate(double newSampleRate)
   return;
 }
 
-void OnePoleFilter::setMode(int newMode)
+template<class T>
+void OnePoleFilterT<T>::setMode(int newMode)
 {
   mode = newMode; // 0:bypass, 1:Low Pass, 2:High Pass
   calcCoeffs();
 }
 
-void OnePoleFilter::setCutoff(double newCutoff)
+template<class T>
+void OnePoleFilterT<T>::setCutoff(double newCutoff)
 {
   if( (newCutoff>0.0) && (newCutoff<=20000.0) )
     cutoff = newCutoff;
@@ -43,7 +47,8 @@ void OnePoleFilter::setCutoff(double newCutoff)
   return;
 }
 
-void OnePoleFilter::setShelvingGain(double newGain)
+template<class T>
+void OnePoleFilterT<T>::setShelvingGain(double newGain)
 {
   if( newGain > 0.0 )
   {
@@ -54,19 +59,22 @@ void OnePoleFilter::setShelvingGain(double newGain)
     DEBUG_BREAK; // this is a linear gain factor and must be >= 0.0
 }
 
-void OnePoleFilter::setShelvingGainInDecibels(double newGain)
+template<class T>
+void OnePoleFilterT<T>::setShelvingGainInDecibels(double newGain)
 {
   setShelvingGain(dB2amp(newGain));
 }
 
-void OnePoleFilter::setCoefficients(double newB0, double newB1, double newA1)
+template<class T>
+void OnePoleFilterT<T>::setCoefficients(double newB0, double newB1, double newA1)
 {
   b0 = newB0;
   b1 = newB1;
   a1 = newA1;
 }
 
-void OnePoleFilter::setInternalState(double newX1, double newY1)
+template<class T>
+void OnePoleFilterT<T>::setInternalState(double newX1, double newY1)
 {
   x1 = newX1;
   y1 = newY1;
@@ -75,7 +83,8 @@ void OnePoleFilter::setInternalState(double newX1, double newY1)
 //-------------------------------------------------------------------------------------------------
 //others:
 
-void OnePoleFilter::calcCoeffs()
+template<class T>
+void OnePoleFilterT<T>::calcCoeffs()
 {
   switch(mode)
   {
@@ -151,8 +160,15 @@ void OnePoleFilter::calcCoeffs()
   }
 }
 
-void OnePoleFilter::reset()
+template<class T>
+void OnePoleFilterT<T>::reset()
 {
   x1 = 0.0;
   y1 = 0.0;
 }
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::OnePoleFilterT<double>;
+template class rosic::OnePoleFilterT<float>;
@@ -9,13 +9,18 @@ namespace rosic
 
   /**
 
-  This is an implementation of a simple one-pole filter unit.
+  This is an implementation of a simple one-pole filter unit. The template parameter is the type
+  of the signal and the filter coefficients (float or double), the parameters are always double.
 
   */
 
-  class OnePoleFilter
+  template<class T>
+  class OnePoleFilterT
   {
 
+    template<int numLanes> friend class Open303xN; // copies coefficients and states
+    template<class> friend class PostFilterChainT; // runs the filters in a fused loop
+
   public:
 
     /** This is an enumeration of the available filter modes. */
@@ -35,7 +40,7 @@ namespace rosic
     // construction/destruction:
 
     /** Constructor. */
-    OnePoleFilter();   
+    OnePoleFilterT();   
 
     //---------------------------------------------------------------------------------------------
     // parameter settings:
@@ -76,7 +81,12 @@ namespace rosic
     // audio processing:
 
     /** Calculates a single filtered output-sample. */
-    INLINE double getSample(double in);
+    INLINE T getSample(T in);
+
+    /** The calculation of getSample on coefficients and states that are passed in (the states are 
+    updated) - shared with the loops that keep the filters in local variables or lanes 
+    (PostFilterChainT, Open303xN). */
+    static INLINE T processSample(T in, T b0, T b1, T a1, T &x1, T &y1);
 
     //---------------------------------------------------------------------------------------------
     // others:
@@ -89,12 +99,12 @@ namespace rosic
   protected:
 
     // buffering:
-    double x1, y1;
+    T x1, y1;
 
     // filter coefficients:
-    double b0; // feedforward coeffs
-    double b1;
-    double a1; // feedback coeff
+    T b0; // feedforward coeffs
+    T b1;
+    T a1; // feedback coeff
 
     // filter parameters:
     double cutoff;
@@ -112,7 +122,14 @@ namespace rosic
   //-----------------------------------------------------------------------------------------------
   // inlined functions:
 
-  INLINE double OnePoleFilter::getSample(double in)
+  template<class T>
+  INLINE T OnePoleFilterT<T>::getSample(T in)
+  {
+    return processSample(in, b0, b1, a1, x1, y1);
+  }
+
+  template<class T>
+  INLINE T OnePoleFilterT<T>::processSample(T in, T b0, T b1, T a1, T &x1, T &y1)
   {
     // calculate the output sample:
     y1 = b0*in + b1*x1 + a1*y1 + TINY;
@@ -123,6 +140,8 @@ namespace rosic
     return y1;
   }
 
+  typedef OnePoleFilterT<double> OnePoleFilter;
+
 } // end namespace rosic
 
 #endif // rosic_OnePoleFilter_h
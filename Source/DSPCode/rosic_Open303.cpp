@@ -5,7 +5,8 @@ using namespace rosic;
 //-------------------------------------------------------------------------------------------------
 // construction/destruction:
 
-Open303::Open303()
+template<class T>
+Open303T<T>::Open303T()
 {
   tuning           =   440.0;
   ampScaler        =     1.0;
@@ -24,12 +25,36 @@ Open303::Open303()
   normalAmpRelease =     1.0;
   accentAmpRelease =    50.0;
   accentGain       =     0.0;
+  pitchBend        =     0.0;
   pitchWheelFactor =     1.0;
+  n1               =     1.0;
+  n2               =     1.0;
+  smoothingTime    =     0.0;
+  envModNormalized =     0.0;
+  cutoffNormalized =     0.0;
+  cutoffNormalizedDelta = 0.0;
   currentNote      =    -1;
   noteOffCountDown =     0;
+  controlRateInterval =  1;
+  antiAliasMode    = ELLIPTIC;
+  oversampling     = 4;
+  numDecimatorStages = 0;
+  silentFrames     = 0;
+  idleHoldFrames   = 0;
+  rampLength       = 0;
+  activeRamps      = 0;
+  blendIsRamping     = false;
+  gainIsRamping      = false;
+  resonanceIsRamping = false;
   slideToNextNote  = false;
   idle             = true;
 
+  for(int p = 0; p < NUM_SMOOTHED_PARAMETERS; p++)
+  {
+    rampValues[p]   = rampTargets[p] = rampDeltas[p] = 0.0;
+    rampCounters[p] = 0;
+  }
+
   setEnvMod(25.0);
 
   oscillator.setWaveTable1(&waveTable1);
@@ -56,24 +81,22 @@ Open303::Open303()
   rc2.setTimeConstant(15.0);
 
   highpass1.setMode(OnePoleFilter::HIGHPASS);
-  highpass2.setMode(OnePoleFilter::HIGHPASS);
-  allpass.setMode(OnePoleFilter::ALLPASS);
-  notch.setMode(BiquadFilter::BANDREJECT);
 
   setSampleRate(sampleRate);
 
   // tweakables:
   oscillator.setPulseWidth(50.0);
   highpass1.setCutoff(44.486);
-  highpass2.setCutoff(24.167);
-  allpass.setCutoff(14.008);
-  notch.setFrequency(7.5164);
-  notch.setBandwidth(4.7);
+  postFilters.setHighpassCutoff(24.167);
+  postFilters.setAllpassCutoff(14.008);
+  postFilters.setNotchFrequency(7.5164);
+  postFilters.setNotchBandwidth(4.7);
 
   filter.setFeedbackHighpassCutoff(150.0);
 }
 
-Open303::~Open303()
+template<class T>
+Open303T<T>::~Open303T()
 {
 
 }
@@ -81,8 +104,11 @@ Open303::~Open303()
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void Open303::setSampleRate(double newSampleRate)
+template<class T>
+void Open303T<T>::setSampleRate(double newSampleRate)
 {
+  sampleRate = newSampleRate;
+
   mainEnv.setSampleRate         (       newSampleRate);
   ampEnv.setSampleRate          (       newSampleRate);
   pitchSlewLimiter.setSampleRate((float)newSampleRate);
@@ -91,40 +117,49 @@ void Open303::setSampleRate(double newSampleRate)
   rc2.setSampleRate(             (float)newSampleRate);
   sequencer.setSampleRate(              newSampleRate);
 
-  highpass2.setSampleRate     (         newSampleRate);
-  allpass.setSampleRate       (         newSampleRate);
-  notch.setSampleRate         (         newSampleRate);
+  postFilters.setSampleRate   (         newSampleRate);
 
   highpass1.setSampleRate     (  oversampling*newSampleRate);
 
   oscillator.setSampleRate    (  oversampling*newSampleRate);
   filter.setSampleRate        (  oversampling*newSampleRate);
+
+  idleHoldFrames = roundToInt(idleHoldTime*newSampleRate);
+  rampLength     = roundToInt(0.001*smoothingTime*newSampleRate);
 }
 
-void Open303::setCutoff(double newCutoff)
+template<class T>
+void Open303T<T>::setCutoff(double newCutoff)
 {
+  stopRamp(CUTOFF);
   cutoff = newCutoff;
   calculateEnvModScalerAndOffset();
 }
 
-void Open303::setEnvMod(double newEnvMod)
+template<class T>
+void Open303T<T>::setEnvMod(double newEnvMod)
 {
+  stopRamp(ENVMOD);
   envMod = newEnvMod;
   calculateEnvModScalerAndOffset();
 }
 
-void Open303::setAccent(double newAccent)
+template<class T>
+void Open303T<T>::setAccent(double newAccent)
 {
   accent = 0.01 * newAccent;
 }
 
-void Open303::setVolume(double newLevel)
+template<class T>
+void Open303T<T>::setVolume(double newLevel)
 {
+  stopRamp(VOLUME);
   level     = newLevel;
   ampScaler = dB2amp(level);
 }
 
-void Open303::setSlideTime(double newSlideTime)
+template<class T>
+void Open303T<T>::setSlideTime(double newSlideTime)
 {
   if( newSlideTime >= 0.0 )
   {
@@ -133,15 +168,357 @@ void Open303::setSlideTime(double newSlideTime)
   }
 }
 
-void Open303::setPitchBend(double newPitchBend)
+template<class T>
+void Open303T<T>::setSmoothingTime(double newSmoothingTime)
+{
+  smoothingTime = rmax(newSmoothingTime, 0.0);
+  rampLength    = roundToInt(0.001*smoothingTime*sampleRate);
+}
+
+template<class T>
+void Open303T<T>::setParameterSmoothly(int parameter, double newValue)
+{
+  if( parameter < 0 || parameter >= NUM_SMOOTHED_PARAMETERS )
+    return;
+
+  // the ramps run on the values that are used in the per sample calculations, so the volume and 
+  // the pitchbend ramp exponentially as ampScaler and pitchWheelFactor:
+  double target;
+  switch( parameter )
+  {
+  case VOLUME:    target = dB2amp(newValue);                  break;
+  case PITCHBEND: target = pitchOffsetToFreqFactor(newValue); break;
+  default:        target = newValue;                          break;
+  }
+
+  // a running ramp continues from where it is, otherwise we start at the current setting:
+  double current;
+  int    bit = 1 << parameter;
+  if( activeRamps & bit )
+    current = rampValues[parameter];
+  else
+  {
+    switch( parameter )
+    {
+    case CUTOFF:    current = cutoff;           break;
+    case RESONANCE: current = getResonance();   break;
+    case ENVMOD:    current = envMod;           break;
+    case VOLUME:    current = ampScaler;        break;
+    case PITCHBEND: current = pitchWheelFactor; break;
+    case TUNING:    current = tuning;           break;
+    default:        current = getWaveform();    break;
+    }
+  }
+
+  bool exponential = (exponentialRamps & bit) != 0;
+  if( idle || rampLength == 0 || (exponential && (current <= 0.0 || target <= 0.0)) )
+  {
+    setParameterDirectly(parameter, newValue);
+    return;
+  }
+
+  if( parameter == VOLUME )
+    level = newValue;
+  else if( parameter == PITCHBEND )
+    pitchBend = newValue;
+  else if( parameter == CUTOFF )
+  {
+    cutoffNormalizedDelta = 
+      (expToLin(target, minNominalCutoff, maxNominalCutoff, 0.0, 1.0) - cutoffNormalized) 
+      / rampLength;
+  }
+
+  activeRamps            |= bit;
+  rampValues[parameter]   = current;
+  rampTargets[parameter]  = target;
+  rampCounters[parameter] = rampLength;
+  if( exponential )
+    rampDeltas[parameter] = pow(target/current, 1.0/rampLength);
+  else
+    rampDeltas[parameter] = (target-current) / rampLength;
+}
+
+template<class T>
+void Open303T<T>::setParameterDirectly(int parameter, double newValue)
+{
+  switch( parameter )
+  {
+  case CUTOFF:    setCutoff(newValue);    break;
+  case RESONANCE: setResonance(newValue); break;
+  case ENVMOD:    setEnvMod(newValue);    break;
+  case VOLUME:    setVolume(newValue);    break;
+  case PITCHBEND: setPitchBend(newValue); break;
+  case WAVEFORM:  setWaveform(newValue);  break;
+  case TUNING:    setTuning(newValue);    break;
+  }
+}
+
+template<class T>
+void Open303T<T>::setControlRateInterval(int newInterval)
 {
+  controlRateInterval = clip(newInterval, 1, maxBlockSize);
+}
+
+template<class T>
+void Open303T<T>::setAntiAliasFilter(int newFilter)
+{
+  if( newFilter < 0 || newFilter >= NUM_ANTI_ALIAS_FILTERS || newFilter == antiAliasMode )
+    return;
+  antiAliasMode = newFilter;
+  updateDecimators();
+}
+
+template<class T>
+void Open303T<T>::setOversampling(int newOversampling)
+{
+  if( newOversampling == oversampling || 
+     (newOversampling != 1 && newOversampling != 2 && newOversampling != 4 && newOversampling != 8) )
+    return;
+  oversampling = newOversampling;
+
+  highpass1.setSampleRate (oversampling*sampleRate);
+  oscillator.setSampleRate(oversampling*sampleRate);
+  filter.setSampleRate    (oversampling*sampleRate);
+  highpass1.reset();
+  filter.reset();
+  updateDecimators();
+}
+
+template<class T>
+void Open303T<T>::updateDecimators()
+{
+  // number of coefficients for the 2x -> 1x, 4x -> 2x and 8x -> 4x stages for the halfband 
+  // qualities (the elliptic filter is replaced by HALFBAND_HIGH for other factors than 4x):
+  static const int numCoeffs[NUM_ANTI_ALIAS_FILTERS][3] = 
+    { {8, 3, 2}, {4, 2, 1}, {6, 2, 2}, {8, 3, 2} };
+
+  numDecimatorStages = 0;
+  while( (1 << numDecimatorStages) < oversampling )
+    numDecimatorStages++;
+  if( antiAliasMode == ELLIPTIC && oversampling == 4 )
+    numDecimatorStages = 0;
+
+  // the passband extends up to 0.907 times the final Nyquist frequency (20 kHz at 44.1 kHz), the
+  // earlier stages only need to suppress what would fold into this band:
+  double passband = 0.25 * 20000.0/22050.0;
+  for(int s = 0; s < numDecimatorStages; s++)
+  {
+    decimators[s].setCoefficients(numCoeffs[antiAliasMode][s], 0.25 - passband);
+    passband *= 0.5;
+  }
+  antiAliasFilter.reset();
+}
+
+template<class T>
+void Open303T<T>::setPitchBend(double newPitchBend)
+{
+  stopRamp(PITCHBEND);
+  pitchBend        = newPitchBend;
   pitchWheelFactor = pitchOffsetToFreqFactor(newPitchBend);
 }
 
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+template<class T>
+void Open303T<T>::processBlock(double* out, int numFrames)
+{
+  while( numFrames > 0 )
+  {
+    int n = std::min(numFrames, maxBlockSize);
+    renderBlock(out, n);
+    out       += n;
+    numFrames -= n;
+  }
+}
+
+template<class T>
+void Open303T<T>::processBlock(float* out, int numFrames)
+{
+  while( numFrames > 0 )
+  {
+    int n = std::min(numFrames, maxBlockSize);
+    renderBlock(out, n);
+    out       += n;
+    numFrames -= n;
+  }
+}
+
+template<class T>
+template<class TOut>
+void Open303T<T>::renderBlock(TOut* out, int numFrames)
+{
+  int n;
+  if( idle )
+  {
+    for(n = 0; n < numFrames; n++)
+      out[n] = 0;
+    return;
+  }
+
+  renderControlSignals(numFrames);
+  renderAudio(numFrames);
+
+  // the filters that run without oversampling and the gains:
+  postFilters.processBlock(signalBuffer, ampBuffer, gainIsRamping ? gainBuffer : nullptr,
+                           ampScaler, out, numFrames);
+
+  // find out whether we may switch ourselves off for the next block:
+  double peak = 0.0;
+  for(n = 0; n < numFrames; n++)
+    peak = rmax(peak, fabs((double) out[n]));
+  updateIdleState(peak, numFrames);
+}
+
+template<class T>
+void Open303T<T>::renderAudio(int numFrames)
+{
+  switch( CpuDispatch::getInstructionSet() )
+  {
+  case CpuDispatch::AVX512: renderAudioAvx512(numFrames); break;
+  case CpuDispatch::AVX2:   renderAudioAvx2(numFrames);   break;
+  default:                  renderAudioKernel(numFrames);
+  }
+}
+
+template<class T>
+O303_TARGET_AVX2 void Open303T<T>::renderAudioAvx2(int numFrames)
+{
+  renderAudioKernel(numFrames);
+}
+
+template<class T>
+O303_TARGET_AVX512 void Open303T<T>::renderAudioAvx512(int numFrames)
+{
+  renderAudioKernel(numFrames);
+}
+
+template<class T>
+O303_KERNEL_INLINE void Open303T<T>::renderAudioKernel(int numFrames)
+{
+  // the oversampled oscillator/filter chain, stage by stage over the whole sub-block in the
+  // oversampledBuffer (the output is the same as with getOversampledSample because each stage
+  // sees the same samples in the same order):
+  T   *x             = oversampledBuffer;
+  int numOversampled = numFrames*oversampling;
+  int n, i, k;
+  for(n = 0, k = 0; n < numFrames; n++)
+  {
+    if( blendIsRamping )
+      oscillator.setBlendFactor(blendBuffer[n]);
+    oscillator.setIncrement(incrementBuffer[n]);
+    for(i = 0; i < oversampling; i++, k++)
+      x[k] = -oscillator.getSample();
+  }
+  for(k = 0; k < numOversampled; k++)
+    x[k] = highpass1.getSample(x[k]);
+  if( filter.getMode() == TeeBeeFilterT<T>::TB_303 )
+    filterBlock<true>(numFrames);
+  else
+    filterBlock<false>(numFrames);
+  decimateBlock(numFrames);
+}
+
+template<class T>
+template<bool tb303Mode>
+O303_KERNEL_INLINE void Open303T<T>::filterBlock(int numFrames)
+{
+  T *x = oversampledBuffer;
+  applyCutoffModulation(numFrames, [this, x](int n)
+  {
+    T *y = x + n*oversampling;
+    for(int i = 0; i < oversampling; i++)
+      y[i] = tb303Mode ? filter.getSampleTB303(y[i]) : filter.getSample(y[i]);
+  });
+}
+
+template<class T>
+O303_KERNEL_INLINE void Open303T<T>::decimateBlock(int numFrames)
+{
+  T   *x = oversampledBuffer;
+  int n, k, s;
+
+  if( numDecimatorStages == 0 && oversampling == 4 )
+  {
+    antiAliasFilter.decimate4(x, signalBuffer, numFrames);
+    return;
+  }
+
+  // decimate by 2 per stage, in place except for the last stage (stage s produces 2^s samples per
+  // output sample):
+  for(s = numDecimatorStages-1; s > 0; s--)
+  {
+    for(k = 0; k < (numFrames << s); k++)
+      x[k] = decimators[s].getSample(x[2*k], x[2*k+1]);
+  }
+  if( numDecimatorStages > 0 )
+  {
+    for(n = 0; n < numFrames; n++)
+      signalBuffer[n] = decimators[0].getSample(x[2*n], x[2*n+1]);
+  }
+  else
+  {
+    for(n = 0; n < numFrames; n++)
+      signalBuffer[n] = x[n];
+  }
+}
+
+// Open303xN renders inactive lanes through these:
+template void Open303T<double>::renderBlock<double>(double* out, int numFrames);
+template void Open303T<double>::renderBlock<float>(float* out, int numFrames);
+
+template<class T>
+void Open303T<T>::renderControlSignals(int numFrames)
+{
+  // the cutoff is only calculated at the control points which are every controlRateInterval-th 
+  // sample, the last sample of the block and the samples right before and at a note-trigger from 
+  // the sequencer (because the envelope jumps there) - or at every sample while the resonance 
+  // ramps (because that requires exact coefficients):
+  int    n;
+  bool   sequencerOn = sequencer.getSequencerMode() != AcidSequencer::OFF;
+  int    last        = numFrames-1;
+  double cutoffOctaves, previousOctaves = 0.0;
+
+  // swap in asynchronously rendered waveforms:
+  waveTable1.updateMipMap();
+  waveTable2.updateMipMap();
+
+  // the ramps that have to be passed to the audio-rate part:
+  blendIsRamping     = rampCounters[WAVEFORM]  > 0;
+  gainIsRamping      = rampCounters[VOLUME]    > 0;
+  resonanceIsRamping = rampCounters[RESONANCE] > 0;
+
+  numControlPoints = 0;
+  for(n = 0; n < numFrames; n++)
+  {
+    bool isControlPoint = n % controlRateInterval == 0 || n == last || resonanceIsRamping;
+    if( sequencerOn && updateSequencer() )
+    {
+      if( n > 0 && controlPoints[numControlPoints-1] != n-1 )
+        addControlPoint(n-1, previousOctaves);
+      isControlPoint = true;
+    }
+    if( activeRamps != 0 )
+      updateRamps();
+    if( blendIsRamping )
+      blendBuffer[n] = rampValues[WAVEFORM];
+    if( gainIsRamping )
+      gainBuffer[n] = ampScaler;
+    if( resonanceIsRamping )
+      resonanceBuffer[n] = rampValues[RESONANCE];
+    calculateControlSignals(cutoffOctaves, ampBuffer[n]);
+    incrementBuffer[n] = oscillator.getIncrement();
+    if( isControlPoint )
+      addControlPoint(n, cutoffOctaves);
+    previousOctaves = cutoffOctaves;
+  }
+}
+
 //------------------------------------------------------------------------------------------------------------
 // others:
 
-void Open303::noteOn(int noteNumber, int velocity)
+template<class T>
+void Open303T<T>::noteOn(int noteNumber, int velocity)
 {
   if( sequencer.modeWasChanged() )
     allNotesOff();
@@ -170,58 +547,41 @@ void Open303::noteOn(int noteNumber, int velocity)
 
   if( velocity == 0 ) // velocity zero indicates note-off events
   {
-    MidiNoteEvent releasedNote(noteNumber, 0);
-    noteList.remove(releasedNote);
-    if( noteList.empty() )
-    {
-      currentNote = -1;
-    }
-    else
-    {
-      currentNote = noteList.front().getKey();
-    }
+    noteStack.remove(noteNumber);
+    currentNote = noteStack.getSoundingKey(); // -1 if no note is held anymore
     releaseNote(noteNumber);
   }
   else // velocity was not zero, so this is an actual note-on
   {
-    // check if the note-list is empty (indicating that currently no note is playing) - if so,
-    // trigger a new note, otherwise, slide to the new note:
-    if( noteList.empty() )
+    // check if the note-stack is empty (indicating that currently no note is playing) - if so,
+    // trigger a new note, otherwise, slide to the new note when it takes over according to the 
+    // note priority:
+    bool wasEmpty = noteStack.isEmpty();
+    noteStack.push(noteNumber, velocity);
+    int soundingKey = noteStack.getSoundingKey();
+    if( wasEmpty )
       triggerNote(noteNumber, velocity >= 100);
-    else
+    else if( soundingKey == noteNumber )
       slideToNote(noteNumber, velocity >= 100);
 
-    currentNote = noteNumber;
-
-    // and we need to add the new note to our list, of course:
-    MidiNoteEvent newNote(noteNumber, velocity);
-    noteList.push_front(newNote);
+    currentNote = soundingKey;
   }
   idle = false;
 }
 
-void Open303::allNotesOff()
+template<class T>
+void Open303T<T>::allNotesOff()
 {
-  noteList.clear();
+  noteStack.clear();
   ampEnv.noteOff();
   currentNote = -1;
 }
 
-void Open303::triggerNote(int noteNumber, bool hasAccent)
+template<class T>
+void Open303T<T>::triggerNote(int noteNumber, bool hasAccent)
 {
-  // retrigger osc and reset filter buffers only if amplitude is near zero (to avoid clicks):
-  if( idle )
-  {
-    oscillator.resetPhase();
-    filter.reset();
-    highpass1.reset();
-    highpass2.reset();
-    allpass.reset();
-    notch.reset();
-    antiAliasFilter.reset();
-    ampDeClicker.reset();
-  }
-
+  // the osc and the filter buffers were reset when we went idle (@see enterIdleState), resetting
+  // them here would click:
   if( hasAccent )
   {
     accentGain = accent;
@@ -242,7 +602,8 @@ void Open303::triggerNote(int noteNumber, bool hasAccent)
   idle = false;
 }
 
-void Open303::slideToNote(int noteNumber, bool hasAccent)
+template<class T>
+void Open303T<T>::slideToNote(int noteNumber, bool hasAccent)
 {
   oscFreq = pitchToFreq(noteNumber, tuning);
 
@@ -261,12 +622,13 @@ void Open303::slideToNote(int noteNumber, bool hasAccent)
   idle = false;
 }
 
-void Open303::releaseNote(int noteNumber)
+template<class T>
+void Open303T<T>::releaseNote(int noteNumber)
 {
-  // check if the note-list is empty now. if so, trigger a release, otherwise slide to the note
-  // at the beginning of the list (this is the most recent one which is still in the list). this
-  // initiates a slide back to the most recent note that is still being held:
-  if( noteList.empty() )
+  // check if the note-stack is empty now. if so, trigger a release, otherwise slide to the note
+  // that sounds according to the note priority (for LAST_NOTE, this is the most recent one which 
+  // is still held). this initiates a slide back to that note:
+  if( noteStack.isEmpty() )
   {
     ampEnv.noteOff();
   }
@@ -277,35 +639,50 @@ void Open303::releaseNote(int noteNumber)
   }
 }
 
-void Open303::setMainEnvDecay(double newDecay)
+template<class T>
+void Open303T<T>::enterIdleState()
+{
+  oscillator.resetPhase();
+  filter.reset();
+  highpass1.reset();
+  postFilters.reset();
+  antiAliasFilter.reset();
+  for(int s = 0; s < numDecimatorStages; s++)
+    decimators[s].reset();
+  ampDeClicker.reset();
+
+  // there is nothing to smooth while we are idle:
+  for(int p = 0; p < NUM_SMOOTHED_PARAMETERS; p++)
+  {
+    if( (activeRamps & (1 << p)) == 0 )
+      continue;
+    if( p == VOLUME )
+      setVolume(level);
+    else if( p == PITCHBEND )
+      setPitchBend(pitchBend);
+    else
+      setParameterDirectly(p, rampTargets[p]);
+  }
+  idle = true;
+}
+
+template<class T>
+void Open303T<T>::setMainEnvDecay(double newDecay)
 {
   mainEnv.setDecayTimeConstant(newDecay);
   updateNormalizer1();
   updateNormalizer2();
 }
 
-void Open303::calculateEnvModScalerAndOffset()
+template<class T>
+void Open303T<T>::calculateEnvModScalerAndOffset()
 {
   bool useMeasuredMapping = true; // might be shown as user parameter later
   if( useMeasuredMapping == true )
   {
-    // define some constants that arise from the measurements:
-    const double c0   = 3.138152786059267e+002;  // lowest nominal cutoff
-    const double c1   = 2.394411986817546e+003;  // highest nominal cutoff
-    const double oF   = 0.048292930943553;       // factor in line equation for offset
-    const double oC   = 0.294391201442418;       // constant in line equation for offset
-    const double sLoF = 3.773996325111173;       // factor in line eq. for scaler at low cutoff
-    const double sLoC = 0.736965594166206;       // constant in line eq. for scaler at low cutoff
-    const double sHiF = 4.194548788411135;       // factor in line eq. for scaler at high cutoff
-    const double sHiC = 0.864344900642434;       // constant in line eq. for scaler at high cutoff
-
-    // do the calculation of the scaler and offset:
-    double e   = linToLin(envMod, 0.0, 100.0, 0.0, 1.0);
-    double c   = expToLin(cutoff, c0,   c1,   0.0, 1.0);
-    double sLo = sLoF*e + sLoC;
-    double sHi = sHiF*e + sHiC;
-    envScaler  = (1-c)*sLo + c*sHi;
-    envOffset  =  oF*c + oC;
+    envModNormalized = linToLin(envMod, 0.0, 100.0, 0.0, 1.0);
+    cutoffNormalized = expToLin(cutoff, minNominalCutoff, maxNominalCutoff, 0.0, 1.0);
+    updateEnvModScalerAndOffset();
   }
   else
   {
@@ -319,16 +696,24 @@ void Open303::calculateEnvModScalerAndOffset()
   }
 }
 
-void Open303::updateNormalizer1()
+template<class T>
+void Open303T<T>::updateNormalizer1()
 {
   n1 = LeakyIntegrator::getNormalizer(mainEnv.getDecayTimeConstant(), rc1.getTimeConstant(),
     sampleRate);
   n1 = 1.0; // test
 }
 
-void Open303::updateNormalizer2()
+template<class T>
+void Open303T<T>::updateNormalizer2()
 {
   n2 = LeakyIntegrator::getNormalizer(mainEnv.getDecayTimeConstant(), rc2.getTimeConstant(),
     sampleRate);
   n2 = 1.0; // test
 }
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::Open303T<double>;
+template class rosic::Open303T<float>;
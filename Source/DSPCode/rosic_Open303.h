@@ -1,7 +1,7 @@
 #ifndef rosic_Open303_h
 #define rosic_Open303_h
 
-#include "rosic_MidiNoteEvent.h"
+#include "rosic_NoteStack.h"
 #include "rosic_BlendOscillator.h"
 #include "rosic_BiquadFilter.h"
 #include "rosic_TeeBeeFilter.h"
@@ -9,9 +9,12 @@
 #include "rosic_DecayEnvelope.h"
 #include "rosic_LeakyIntegrator.h"
 #include "rosic_EllipticQuarterBandFilter.h"
+#include "rosic_HalfbandDecimator.h"
+#include "rosic_PostFilterChain.h"
 #include "rosic_AcidSequencer.h"
+#include "rosic_FastMath.h"
+#include "rosic_CpuDispatch.h"
 
-#include <list>
 #include <limits>
 
 namespace rosic
@@ -20,23 +23,65 @@ namespace rosic
   /**
 
   This is a monophonic bass-synth that aims to emulate the sound of the famous Roland TB 303 and
-  goes a bit beyond.
+  goes a bit beyond. The template parameter is the sample type of the audio-rate part (oscillator,
+  wavetables and filters) whereas the control-rate part (sequencer, envelopes, cutoff modulation) 
+  always runs in double precision. Open303 is the double precision version, Open303Float uses 
+  single precision, which halves the memory of the wavetables (to 116 kB per instance) and doubles 
+  the number of samples per vector register. The elliptic anti-aliasing filter and the notch always
+  run in double precision because their poles are too close to the unit circle for rounded 
+  coefficients (the elliptic filter becomes unstable, the notch deviates by -59 dB). The output of 
+  the float version deviates from the double version by less than -100 dB (relative to the peak 
+  level) at 4x and 8x oversampling with either anti-aliasing filter, measured with a sequence of 
+  accented notes with 95% resonance and full envmod (-113 dB at 4x, -104 dB at 8x, checked by 
+  o303regress). The magnitude spectra of single frames deviate by up to -103 dB at 4x and -86 dB 
+  at 8x.
 
   */
 
-  class Open303
+  template<class T>
+  class Open303T
   {
 
+    // Open303xN renders the audio-rate part of several instances side by side from their control 
+    // buffers:
+    template<int numLanes> friend class Open303xN;
+
   public:
 
+    /** Enumeration of the filters for the decimation of the oversampled signal. */
+    enum antiAliasFilters
+    {
+      ELLIPTIC = 0,     // 12th order elliptic quarterband filter (4x only, HALFBAND_HIGH otherwise)
+      HALFBAND_LOW,     // cascade of polyphase halfband decimators with 52 dB alias rejection
+      HALFBAND_MEDIUM,  // ...with 67 dB alias rejection
+      HALFBAND_HIGH,    // ...with 96 dB alias rejection
+
+      NUM_ANTI_ALIAS_FILTERS
+    };
+
+    /** Enumeration of the parameters that can be changed with a ramp (@see setParameterSmoothly). 
+    */
+    enum smoothedParameters
+    {
+      CUTOFF = 0,  // in Hz, ramps exponentially
+      RESONANCE,   // in percent
+      ENVMOD,      // in percent
+      VOLUME,      // in dB
+      PITCHBEND,   // in semitones
+      WAVEFORM,    // between 0...1 (saw...square)
+      TUNING,      // in Hz, applies to the notes that start or slide while it ramps
+
+      NUM_SMOOTHED_PARAMETERS
+    };
+
     //-----------------------------------------------------------------------------------------------
     // construction/destruction:
 
     /** Constructor. */
-    Open303();
+    Open303T();
 
     /** Destructor. */
-    ~Open303();
+    ~Open303T();
 
     //-----------------------------------------------------------------------------------------------
     // parameter settings:
@@ -46,16 +91,28 @@ namespace rosic
 
     /** Sets up the waveform continuously between saw and square - the input should be in the range 
     0...1 where 0 means pure saw and 1 means pure square. */
-    void setWaveform(double newWaveform) { oscillator.setBlendFactor(newWaveform); }
+    void setWaveform(double newWaveform) 
+    { 
+      stopRamp(WAVEFORM);
+      oscillator.setBlendFactor(newWaveform); 
+    }
 
     /** Sets the master tuning frequency for note A4 (usually 440 Hz). */
-    void setTuning(double newTuning) { tuning = newTuning; }
+    void setTuning(double newTuning) 
+    { 
+      stopRamp(TUNING);
+      tuning = newTuning; 
+    }
 
     /** Sets the filter's nominal cutoff frequency (in Hz). */
     void setCutoff(double newCutoff); 
 
     /** Sets the resonance amount for the filter. */
-    void setResonance(double newResonance) { filter.setResonance(newResonance); }
+    void setResonance(double newResonance) 
+    { 
+      stopRamp(RESONANCE);
+      filter.setResonance(newResonance); 
+    }
 
     /** Sets the modulation depth of the filter's cutoff frequency by the filter-envelope generator 
     (in percent). */
@@ -89,6 +146,46 @@ namespace rosic
     void setTanhShaperOffset(double newOffset) 
     { waveTable2.setTanhShaperOffsetFor303Square(newOffset); }
 
+    /** Switches asynchronous rendering of the oscillator's waveforms on or off. When it's on, 
+    changing the tanh-shaper or the phase shift of the square wave doesn't render the new waveform 
+    on the calling thread but on a background thread and the new waveform is swapped in at the 
+    start of a subsequent block (or sample) - switch it on when these parameters are set on the 
+    audio thread. */
+    void setAsynchronousWaveformRendering(bool shouldBeAsynchronous)
+    {
+      waveTable1.setAsynchronousRendering(shouldBeAsynchronous);
+      waveTable2.setAsynchronousRendering(shouldBeAsynchronous);
+    }
+
+    /** Sets the interval (in samples) at which the cutoff modulation is evaluated and the filter 
+    coefficients are recomputed inside processBlock. In between, the coefficients are interpolated 
+    linearly. The coefficients are always exact at block boundaries and at notes triggered by the 
+    sequencer. An interval of 1 (the default) recomputes them at every sample, exactly as 
+    getSample() does. The envelopes themselves still run at the full rate. Longer intervals 
+    deviate more from the per-sample output (see the ReadMe for measurements). */
+    void setControlRateInterval(int newInterval);
+
+    /** Selects the filter for the decimation of the oversampled signal (@see antiAliasFilters). The
+    elliptic filter has to run on all oversampled samples. The halfband decimators only compute the
+    samples that are kept and are flat up to 20 kHz (at 44.1 kHz) whereas the elliptic filter is
+    down by 2.3 dB there. HALFBAND_LOW is the fastest with the least alias rejection, 
+    HALFBAND_HIGH rejects as much as the elliptic filter (see the ReadMe for measurements). */
+    void setAntiAliasFilter(int newFilter);
+
+    /** Sets the oversampling factor for the oscillator and the filter - can be 1, 2, 4 (the 
+    default) or 8. The halfband cascades are matched to the factor such that the alias rejection of
+    the selected quality stays the same at 8x (and is a bit better at 2x), the elliptic filter 
+    exists only for 4x and is replaced by HALFBAND_HIGH otherwise. The cutoff of the main filter is
+    limited to 0.24 times the oversampled rate (10.5 kHz at 1x and 44.1 kHz). The time per sample 
+    grows with the factor (see the ReadMe for measurements). */
+    void setOversampling(int newOversampling);
+
+    /** Selects the algorithm of the oscillator (@see BlendOscillatorT::algorithms). The mip-mapped
+    wavetables are band-limited to a quarter of the oversampled rate, so they sound dull at 1x. 
+    The PolyBLEP waveforms have their full bandwidth but more aliasing, which decreases with the 
+    oversampling factor (see the ReadMe for measurements). */
+    void setOscillatorAlgorithm(int newAlgorithm) { oscillator.setAlgorithm(newAlgorithm); }
+
     /** Sets the cutoff frequency for the highpass before the main filter. */
     void setPreFilterHighpass(double newCutoff) { highpass1.setCutoff(newCutoff); }
 
@@ -96,7 +193,7 @@ namespace rosic
     void setFeedbackHighpass(double newCutoff) { filter.setFeedbackHighpassCutoff(newCutoff); }
 
     /** Sets the cutoff frequency for the highpass after the main filter. */
-    void setPostFilterHighpass(double newCutoff) { highpass2.setCutoff(newCutoff); }
+    void setPostFilterHighpass(double newCutoff) { postFilters.setHighpassCutoff(newCutoff); }
 
     /** Sets the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
@@ -139,6 +236,22 @@ namespace rosic
       ampEnv.setRelease(newAmpRelease); 
     }
 
+    /** Sets the time (in milliseconds) over which the parameters that are set with 
+    setParameterSmoothly ramp from their current to their new value. The default is zero, which 
+    makes them take effect immediately. */
+    void setSmoothingTime(double newSmoothingTime);
+
+    /** Selects which of the held notes sounds when more than one key is held 
+    (@see NoteStack::notePriorities). The default is NoteStack::LAST_NOTE. */
+    void setNotePriority(int newPriority) { noteStack.setNotePriority(newPriority); }
+
+    /** Sets one of the smoothedParameters (in the unit of its setter) such that it ramps to the new
+    value over the smoothing time. The ramps are evaluated per sample inside getSample and 
+    processBlock, the cutoff ramps linearly in octaves, the others linearly in their units. While 
+    we are idle, the new value is set immediately. Calling the normal setter (setCutoff, etc.) also
+    sets the value immediately and stops a running ramp. */
+    void setParameterSmoothly(int parameter, double newValue);
+
     //-----------------------------------------------------------------------------------------------
     // inquiry:
 
@@ -191,7 +304,7 @@ namespace rosic
     double getFeedbackHighpass() const { return filter.getFeedbackHighpassCutoff(); }
 
     /** Returns the cutoff frequency for the highpass after the main filter. */
-    double getPostFilterHighpass() const { return highpass2.getCutoff(); }
+    double getPostFilterHighpass() const { return postFilters.getHighpassCutoff(); }
 
     /** Returns the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
@@ -215,11 +328,46 @@ namespace rosic
     /** Returns the amplitudes envelope's release time (in milliseconds). */
     double getAmpRelease() const { return normalAmpRelease; }
 
+    /** Returns the time (in milliseconds) of the ramps for setParameterSmoothly. */
+    double getSmoothingTime() const { return smoothingTime; }
+
+    /** Returns the note priority (@see NoteStack::notePriorities). */
+    int getNotePriority() const { return noteStack.getNotePriority(); }
+
+    /** Returns the interval (in samples) at which the filter coefficients are recomputed inside 
+    processBlock. */
+    int getControlRateInterval() const { return controlRateInterval; }
+
+    /** Returns the filter that is used for the decimation of the oversampled signal. */
+    int getAntiAliasFilter() const { return antiAliasMode; }
+
+    /** Returns the oversampling factor for the oscillator and the filter. */
+    int getOversampling() const { return oversampling; }
+
+    /** Returns the algorithm of the oscillator (@see BlendOscillatorT::algorithms). */
+    int getOscillatorAlgorithm() const { return oscillator.getAlgorithm(); }
+
+    /** Returns true when there is nothing to play, i.e. no note is on, the sequencer is stopped 
+    and the tail of the last note has decayed. getSample and processBlock then return zeros 
+    without any processing until the next note. */
+    bool isIdle() const { return idle; }
+
     //-----------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Calculates onse output sample at a time. */
-    double getSample(); 
+    T getSample(); 
+
+    /** Calculates a block of output samples at a time. This produces the same output as calling 
+    getSample() numFrames times but runs the control-rate parts (sequencer, pitch-slew, envelopes, 
+    cutoff modulation) and the audio-rate parts in separate loops over the block, which is 
+    considerably more efficient. The only difference is that the switch to the idle state is 
+    checked once per block (so the last samples of a tail below idleThreshold may differ). */
+    void processBlock(double* out, int numFrames);
+
+    /** Single precision version of processBlock. The internal calculations are done in the 
+    precision of the template parameter. */
+    void processBlock(float* out, int numFrames);
 
     //-----------------------------------------------------------------------------------------------
     // event handling:
@@ -236,18 +384,19 @@ namespace rosic
     //-----------------------------------------------------------------------------------------------
     // embedded objects: 
 
-    MipMappedWaveTable        waveTable1, waveTable2;
-    BlendOscillator           oscillator;
-    TeeBeeFilter              filter;
+    MipMappedWaveTableT<T>    waveTable1, waveTable2;
+    BlendOscillatorT<T>       oscillator;
+    TeeBeeFilterT<T>          filter;
     AnalogEnvelope            ampEnv; 
     DecayEnvelope             mainEnv;
     LeakyIntegrator           pitchSlewLimiter;
     //LeakyIntegrator           ampDeClicker;
     BiquadFilter              ampDeClicker;
     LeakyIntegrator           rc1, rc2;
-    OnePoleFilter             highpass1, highpass2, allpass; 
-    BiquadFilter              notch;
+    OnePoleFilterT<T>         highpass1; 
+    PostFilterChainT<T>       postFilters;   // allpass, highpass and notch
     EllipticQuarterBandFilter antiAliasFilter;
+    HalfbandDecimatorT<T>     decimators[3]; // 2x -> 1x, 4x -> 2x, 8x -> 4x
     AcidSequencer             sequencer;
 
   protected:
@@ -264,11 +413,90 @@ namespace rosic
     used). */
     void releaseNote(int noteNumber);
 
+    /** Lets the sequencer trigger, slide or release notes, if there is something to do at this 
+    sample (called per sample in getSample and in processBlock when the sequencer is used). Returns
+    true when a note was triggered or slid to. */
+    INLINE bool updateSequencer();
+
+    /** Advances the pitch-slew limiter and the envelopes by one sample, sets up the oscillator's 
+    phase increment and returns the cutoff modulation (in octaves with respect to the nominal 
+    cutoff) and the amplitude. */
+    INLINE void calculateControlSignals(double &cutoffOctaves, double &ampEnvOut);
+
+    /** Runs the oversampled part of the signal chain (oscillator, pre-filter highpass, main filter
+    and anti-aliasing filter) for one output sample. */
+    INLINE T getOversampledSample();
+
+    /** Counts the samples in which the output stayed below idleThreshold after the amp-envelope 
+    has ended and enters the idle state when they add up to the hold time. peak is the maximum 
+    absolute output of the last numFrames samples. */
+    INLINE void updateIdleState(double peak, int numFrames);
+
+    /** Switches to the idle state and resets the oscillator and the filters, such that the next 
+    note starts like on a freshly created instance. */
+    void enterIdleState();
+
+    /** Sets one of the smoothedParameters immediately via its setter. */
+    void setParameterDirectly(int parameter, double newValue);
+
+    /** Stops the ramp of one of the smoothedParameters (if running) at its current value. */
+    INLINE void stopRamp(int parameter);
+
+    /** Advances the running parameter ramps by one sample and applies their values, except for the
+    resonance which is applied along with the cutoff in the audio-rate part. */
+    INLINE void updateRamps();
+
+    /** Adds a sample index at which the cutoff is calculated exactly in processBlock. */
+    INLINE void addControlPoint(int index, double cutoffOctaves);
+
+    /** Runs the control-rate part (sequencer, pitch-slew, envelopes, cutoff modulation) for a 
+    sub-block of at most maxBlockSize samples and fills the incrementBuffer, ampBuffer and the 
+    cutoffBuffer at the control points. */
+    void renderControlSignals(int numFrames);
+
+    /** Sets up the filter coefficients from the cutoffBuffer (and the resonanceBuffer while the 
+    resonance ramps) for each sample of the sub-block in turn and calls processSample(n) after each
+    setup - the coefficients are exact at the control points and ramp linearly in between. */
+    template<class Callback>
+    O303_KERNEL_INLINE void applyCutoffModulation(int numFrames, Callback processSample);
+
+    /** Renders the audio-rate part of a sub-block (oscillator, filter and decimation) from the
+    control signals into the signalBuffer with the variant for the selected instruction set
+    (@see CpuDispatch). */
+    void renderAudio(int numFrames);
+
+    /** The implementation of renderAudio and its variants for the instruction sets. */
+    O303_KERNEL_INLINE void renderAudioKernel(int numFrames);
+    O303_TARGET_AVX2   void renderAudioAvx2(int numFrames);
+    O303_TARGET_AVX512 void renderAudioAvx512(int numFrames);
+
+    /** Runs the main filter over the numFrames*oversampling samples in the oversampledBuffer - 
+    tb303Mode selects the loop without the mode branch (@see TeeBeeFilterT::getSampleTB303). */
+    template<bool tb303Mode>
+    O303_KERNEL_INLINE void filterBlock(int numFrames);
+
+    /** Decimates the numFrames*oversampling samples in the oversampledBuffer into the 
+    signalBuffer. */
+    O303_KERNEL_INLINE void decimateBlock(int numFrames);
+
+    /** Renders a sub-block of at most maxBlockSize samples - called from processBlock. */
+    template<class TOut>
+    void renderBlock(TOut* out, int numFrames);
+
+    /** Sets up the halfband decimators according to the oversampling factor and the selected 
+    anti-aliasing filter. */
+    void updateDecimators();
+
     /** Sets the decay-time of the main envelope and updates the normalizers n1, n2 accordingly. */
     void setMainEnvDecay(double newDecay);
 
+    /** Calculates envScaler and envOffset from the cutoff and the envMod. */
     void calculateEnvModScalerAndOffset();
 
+    /** Calculates envScaler and envOffset from cutoffNormalized and envModNormalized - this is 
+    cheap enough to be done per sample while these ramp. */
+    INLINE void updateEnvModScalerAndOffset();
+
     /** Updates the normalizer n1 according to the time-constant of rc1 and the decay-time of the
     main envelope generator. */
     void updateNormalizer1();
@@ -277,7 +505,13 @@ namespace rosic
     main envelope generator. */
     void updateNormalizer2();
 
-    static const int oversampling = 4;
+    static const int maxOversampling = 8;
+    static constexpr int maxBlockSize = 64;  // processBlock works on sub-blocks of at most this size
+    static constexpr double idleThreshold = 0.000001; // output level below which we may go idle
+    static constexpr double idleHoldTime  = 0.05;     // time (in s) to stay below it before that
+    static constexpr double minNominalCutoff = 3.138152786059267e+002; // measured range of the 
+    static constexpr double maxNominalCutoff = 2.394411986817546e+003; // nominal cutoff
+    static constexpr int    exponentialRamps = (1 << CUTOFF) | (1 << VOLUME) | (1 << PITCHBEND);
 
     double tuning;           // master tunung for A4 in Hz
     double ampScaler;        // final volume as raw factor
@@ -299,69 +533,104 @@ namespace rosic
     double normalAmpRelease; // amp-env release time for non-accented notes
     double accentAmpRelease; // amp-env release time for accented notes
     double accentGain;       // between 0.0...1.0 - to scale the 3rd amp-envelope on accents
+    double pitchBend;        // pitchbend in semitones
     double pitchWheelFactor; // scale factor for oscillator frequency from pitch-wheel
     double n1, n2;           // normalizers for the RCs that are driven by the MEG
+    double envModNormalized; // envMod mapped to 0...1
+    double cutoffNormalized; // cutoff mapped to 0...1 (exponentially, over the nominal range)
+    double cutoffNormalizedDelta; // increment of cutoffNormalized per sample while the cutoff ramps
+    double smoothingTime;    // duration of the parameter ramps in ms
     int    currentNote;      // note which is currently played (-1 if none)
     int    noteOffCountDown; // a countdown variable till next note-off in sequencer mode
+    int    controlRateInterval; // interval for the filter coefficient updates in processBlock
+    int    antiAliasMode;    // the selected anti-aliasing filter (@see antiAliasFilters)
+    int    oversampling;     // oversampling factor for the oscillator and filter
+    int    numDecimatorStages; // number of used halfband decimators (0 for the elliptic filter)
+    int    silentFrames;     // number of samples since the output fell below idleThreshold
+    int    idleHoldFrames;   // idleHoldTime in samples
+    int    rampLength;       // smoothingTime in samples
+    int    activeRamps;      // bitmask of the smoothedParameters that are currently ramping
+    bool   blendIsRamping;     // the ramp states of the audio-rate parameters at the start of the
+    bool   gainIsRamping;      // current sub-block in processBlock - the ramps of these are passed
+    bool   resonanceIsRamping; // to the audio-rate part via the buffers below
     bool   slideToNextNote;  // indicate that we need to slide to the next note in sequencer mode
     bool   idle;             // flag to indicate that we have currently nothing to do in getSample
 
-    std::list<MidiNoteEvent> noteList;
+    NoteStack noteStack;     // the held keys (fixed capacity, so noteOn doesn't allocate)
+
+    // the parameter ramps (the values of the volume and pitchbend ramps are ampScaler and 
+    // pitchWheelFactor, the deltas of the exponentialRamps are factors):
+    double rampValues[NUM_SMOOTHED_PARAMETERS];   // current values
+    double rampTargets[NUM_SMOOTHED_PARAMETERS];  // values at the end of the ramps
+    double rampDeltas[NUM_SMOOTHED_PARAMETERS];   // increments per sample
+    int    rampCounters[NUM_SMOOTHED_PARAMETERS]; // remaining samples (0 for a finished ramp)
+
+    // buffers for the control signals and the output of the oversampled part in processBlock:
+    double incrementBuffer[maxBlockSize]; // phase increments for the oscillator
+    double cutoffBuffer[maxBlockSize];    // instantaneous cutoff frequencies (at control points)
+    int    controlPoints[maxBlockSize];   // sample indices at which the cutoff was calculated
+    int    numControlPoints;
+    double ampBuffer[maxBlockSize];       // output of the amplitude envelope (de-clicked)
+    double gainBuffer[maxBlockSize];      // ampScaler while the volume ramps
+    double blendBuffer[maxBlockSize];     // oscillator blend factor while the waveform ramps
+    double resonanceBuffer[maxBlockSize]; // resonance while it ramps
+    T      signalBuffer[maxBlockSize];    // signal after the anti-aliasing filter
+
+    // the oversampled signal of the sub-block, processed in place by the stages of the oversampled
+    // part (aligned to cache lines for vectorized stages):
+    alignas(64) T oversampledBuffer[maxBlockSize*maxOversampling];
 
   };
 
   //-------------------------------------------------------------------------------------------------
   // inlined functions:
 
-  inline double Open303::getSample()
+  template<class T>
+  INLINE bool Open303T<T>::updateSequencer()
   {
-    //if( sequencer.getSequencerMode() == AcidSequencer::OFF && ampEnv.endIsReached() )
-    //  return 0.0;
-    if( idle )
-      return 0.0;
+    noteOffCountDown--;
+    if( noteOffCountDown == 0 || sequencer.isRunning() == false )
+      releaseNote(currentNote);
 
-    // check the sequencer if we have some note to trigger:
-    if( sequencer.getSequencerMode() != AcidSequencer::OFF )
+    AcidNote *note = sequencer.getNote();
+    if( note != NULL )
     {
-      noteOffCountDown--;
-      if( noteOffCountDown == 0 || sequencer.isRunning() == false )
-        releaseNote(currentNote);
-
-      AcidNote *note = sequencer.getNote();
-      if( note != NULL )
+      if( note->gate == true && currentNote != -1)
       {
-        if( note->gate == true && currentNote != -1)
+        int key = note->playKey + 12*note->octave + currentNote;
+        key = clip(key, 0, 127);
+
+        if( !slideToNextNote )
+          triggerNote(key, note->accent);
+        else
+          slideToNote(key, note->accent);
+
+        AcidNote* nextNote = sequencer.getNextScheduledNote();
+        if( note->slide && nextNote->gate == true )
+        {
+          noteOffCountDown = std::numeric_limits<int>::max();
+          slideToNextNote  = true;
+        }
+        else
         {
-          int key = note->playKey + 12*note->octave + currentNote;
-          key = clip(key, 0, 127);
-
-          if( !slideToNextNote )
-            triggerNote(key, note->accent);
-          else
-            slideToNote(key, note->accent);
-
-          AcidNote* nextNote = sequencer.getNextScheduledNote();
-          if( note->slide && nextNote->gate == true )
-          {
-            noteOffCountDown = std::numeric_limits<int>::max();
-            slideToNextNote  = true;
-          }
-          else
-          {
-            noteOffCountDown = sequencer.getStepLengthInSamples()*sequencer.getPatternTempoMul();
-            slideToNextNote  = false;
-          }
+          noteOffCountDown = sequencer.getStepLengthInSamples()*sequencer.getPatternTempoMul();
+          slideToNextNote  = false;
         }
+        return true;
       }
     }
+    return false;
+  }
 
+  template<class T>
+  INLINE void Open303T<T>::calculateControlSignals(double &cutoffOctaves, double &ampEnvOut)
+  {
     // calculate instantaneous oscillator frequency and set up the oscillator:
     double instFreq = pitchSlewLimiter.getSample(oscFreq);
     oscillator.setFrequency(instFreq*pitchWheelFactor);
     oscillator.calculateIncrement();
 
-    // calculate instantaneous cutoff frequency from the nominal cutoff and all its modifiers and 
-    // set up the filter:
+    // calculate the cutoff modulation from the main envelope:
     double mainEnvOut = mainEnv.getSample();
     double tmp1       = n1 * rc1.getSample(mainEnvOut);
     double tmp2       = 0.0;
@@ -370,42 +639,225 @@ namespace rosic
     tmp2 = n2 * rc2.getSample(tmp2);  
     tmp1 = envScaler * ( tmp1 - envOffset );  // seems not to work yet
     tmp2 = accentGain*tmp2;
-    double instCutoff = cutoff * pow(2.0, tmp1+tmp2);
-    filter.setCutoff(instCutoff);
+    cutoffOctaves = tmp1+tmp2;
 
-    double ampEnvOut = ampEnv.getSample();
+    ampEnvOut = ampEnv.getSample();
     //ampEnvOut += 0.45*filterEnvOut + accentGain*6.8*filterEnvOut; 
     if( ampEnv.isNoteOn() )
       ampEnvOut += (0.45 + 4 * accentGain) * mainEnvOut; 
     ampEnvOut = ampDeClicker.getSample(ampEnvOut);
+  }
 
-    // oversampled calculations:
-    double tmp;
-    for(int i=1; i<=oversampling; i++)
+  template<class T>
+  INLINE T Open303T<T>::getOversampledSample()
+  {
+    T tmp;
+    if( numDecimatorStages == 0 && oversampling == 4 )
+    {
+      for(int i=1; i<=4; i++)
+      {
+        tmp  = -oscillator.getSample();         // the raw oscillator signal 
+        tmp  = highpass1.getSample(tmp);        // pre-filter highpass
+        tmp  = filter.getSample(tmp);           // now it's filtered
+        tmp  = antiAliasFilter.getSample(tmp);  // anti-aliasing filtered
+      }
+      return tmp;
+    }
+
+    T   x[maxOversampling];
+    int i, s;
+    for(i=0; i<oversampling; i++)
+    {
+      tmp  = -oscillator.getSample();
+      tmp  = highpass1.getSample(tmp);
+      x[i] = filter.getSample(tmp);
+    }
+
+    // decimate by 2 per stage, stage s produces 2^s samples:
+    for(s=numDecimatorStages-1; s>=0; s--)
+    {
+      for(i=0; i<(1<<s); i++)
+        x[i] = decimators[s].getSample(x[2*i], x[2*i+1]);
+    }
+    return x[0];
+  }
+
+  template<class T>
+  INLINE void Open303T<T>::updateIdleState(double peak, int numFrames)
+  {
+    // the sequencer needs to be called at every sample while it is running and the filters may
+    // still ring for a while after the amp-envelope has ended:
+    if(    peak >= idleThreshold || !ampEnv.endIsReached() 
+        || (sequencer.getSequencerMode() != AcidSequencer::OFF && sequencer.isRunning()) )
+    {
+      silentFrames = 0;
+      return;
+    }
+    silentFrames += numFrames;
+    if( silentFrames >= idleHoldFrames )
+      enterIdleState();
+  }
+
+  template<class T>
+  INLINE void Open303T<T>::stopRamp(int parameter)
+  {
+    rampCounters[parameter] = 0;
+    activeRamps &= ~(1 << parameter);
+  }
+
+  template<class T>
+  INLINE void Open303T<T>::updateRamps()
+  {
+    // only the active ramps are visited - the envelope scaler and offset are updated from the 
+    // normalized cutoff and envmod while these ramp and calculated exactly when a ramp ends:
+    bool envModChanged = false, envModRampEnded = false;
+    for(int p = 0, bits = activeRamps; bits != 0; p++, bits >>= 1)
     {
-      tmp  = -oscillator.getSample();         // the raw oscillator signal 
-      tmp  = highpass1.getSample(tmp);        // pre-filter highpass
-      tmp  = filter.getSample(tmp);           // now it's filtered
-      tmp  = antiAliasFilter.getSample(tmp);  // anti-aliasing filtered
+      if( (bits & 1) == 0 )
+        continue;
 
+      bool ended = --rampCounters[p] == 0;
+      if( ended )
+      {
+        rampValues[p] = rampTargets[p];  // avoid accumulated rounding errors at the end
+        activeRamps  &= ~(1 << p);
+      }
+      else if( exponentialRamps & (1 << p) )
+        rampValues[p] *= rampDeltas[p];
+      else
+        rampValues[p] += rampDeltas[p];
+
+      double value = rampValues[p];
+      switch( p )
+      {
+      case CUTOFF:
+        cutoff            = value;
+        cutoffNormalized += cutoffNormalizedDelta;
+        envModChanged     = true;
+        envModRampEnded  |= ended;
+        break;
+      case ENVMOD:
+        envMod            = value;
+        envModNormalized  = linToLin(value, 0.0, 100.0, 0.0, 1.0);
+        envModChanged     = true;
+        envModRampEnded  |= ended;
+        break;
+      case VOLUME:    ampScaler        = value;        break;
+      case PITCHBEND: pitchWheelFactor = value;        break;
+      case WAVEFORM:  oscillator.setBlendFactor(value); break;
+      case TUNING:    tuning           = value;        break;
+      }
     }
+    if( envModRampEnded )
+      calculateEnvModScalerAndOffset();
+    else if( envModChanged )
+      updateEnvModScalerAndOffset();
+  }
+
+  template<class T>
+  INLINE void Open303T<T>::updateEnvModScalerAndOffset()
+  {
+    // define some constants that arise from the measurements:
+    const double oF   = 0.048292930943553;       // factor in line equation for offset
+    const double oC   = 0.294391201442418;       // constant in line equation for offset
+    const double sLoF = 3.773996325111173;       // factor in line eq. for scaler at low cutoff
+    const double sLoC = 0.736965594166206;       // constant in line eq. for scaler at low cutoff
+    const double sHiF = 4.194548788411135;       // factor in line eq. for scaler at high cutoff
+    const double sHiC = 0.864344900642434;       // constant in line eq. for scaler at high cutoff
+
+    // do the calculation of the scaler and offset:
+    double e   = envModNormalized;
+    double c   = cutoffNormalized;
+    double sLo = sLoF*e + sLoC;
+    double sHi = sHiF*e + sHiC;
+    envScaler  = (1-c)*sLo + c*sHi;
+    envOffset  =  oF*c + oC;
+  }
+
+  template<class T>
+  INLINE void Open303T<T>::addControlPoint(int index, double cutoffOctaves)
+  {
+    cutoffBuffer[index]             = cutoff * fastExp2<MATH_HIGH>(cutoffOctaves);
+    controlPoints[numControlPoints] = index;
+    numControlPoints++;
+  }
+
+  template<class T>
+  template<class Callback>
+  O303_KERNEL_INLINE void Open303T<T>::applyCutoffModulation(int numFrames, Callback processSample)
+  {
+    int n;
+    if( controlRateInterval == 1 || resonanceIsRamping )
+    {
+      for(n = 0; n < numFrames; n++)
+      {
+        filter.setCutoff(cutoffBuffer[n]);
+        if( resonanceIsRamping )
+          filter.setResonance(resonanceBuffer[n]);
+        processSample(n);
+      }
+      return;
+    }
+
+    filter.setCutoff(cutoffBuffer[0]);
+    for(int i = 1; i < numControlPoints; i++)
+    {
+      int start = controlPoints[i-1];
+      int end   = controlPoints[i];
+      filter.setCutoffRamped(cutoffBuffer[end], end-start);
+      for(n = start; n < end; n++)
+      {
+        processSample(n);
+        filter.incrementCoefficients();
+      }
+    }
+    processSample(numFrames-1);
+  }
+
+  template<class T>
+  inline T Open303T<T>::getSample()
+  {
+    if( idle )
+      return 0.0;
+
+    // swap in asynchronously rendered waveforms:
+    waveTable1.updateMipMap();
+    waveTable2.updateMipMap();
+
+    // check the sequencer if we have some note to trigger:
+    if( sequencer.getSequencerMode() != AcidSequencer::OFF )
+      updateSequencer();
+
+    // advance the parameter ramps:
+    bool resonanceRamps = rampCounters[RESONANCE] > 0;
+    if( activeRamps != 0 )
+      updateRamps();
+
+    // calculate the control signals and set up the filter:
+    double cutoffOctaves, ampEnvOut;
+    calculateControlSignals(cutoffOctaves, ampEnvOut);
+    filter.setCutoff(cutoff * fastExp2<MATH_HIGH>(cutoffOctaves));
+    if( resonanceRamps )
+      filter.setResonance(rampValues[RESONANCE]);
+
+    // oversampled calculations:
+    T tmp = getOversampledSample();
 
     // these filters may actually operate without oversampling (but only if we reset them in
     // triggerNote - avoid clicks)
-    tmp  = allpass.getSample(tmp);
-    tmp  = highpass2.getSample(tmp);        
-    tmp  = notch.getSample(tmp);
+    tmp  = postFilters.getSample(tmp);
     tmp *= ampEnvOut;                       // amplified
     tmp *= ampScaler;
 
     // find out whether we may switch ourselves off for the next call:
-    idle = false;
-    //idle = (sequencer.getSequencerMode() == AcidSequencer::OFF && ampEnv.endIsReached() 
-    //        && fabs(tmp) < 0.000001); // ampEnvOut < 0.000001;
+    updateIdleState(fabs((double) tmp), 1);
 
     return tmp;
   }
 
+  typedef Open303T<double> Open303;
+  typedef Open303T<float>  Open303Float;
+
 }
 
 #endif 
@@ -0,0 +1,281 @@
+#include "rosic_Open303xN.h"
+
+#include <algorithm>
+
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+template<int numLanes>
+Open303xN<numLanes>::Open303xN()
+{
+  for(int v = 0; v < numLanes; v++)
+    active[v] = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+template<int numLanes>
+void Open303xN<numLanes>::setSampleRate(double newSampleRate)
+{
+  for(int v = 0; v < numLanes; v++)
+    voices[v].setSampleRate(newSampleRate);
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+template<int numLanes>
+void Open303xN<numLanes>::processBlock(double* const* out, int numFrames)
+{
+  double* tmp[numLanes];
+  for(int v = 0; v < numLanes; v++)
+    tmp[v] = out[v];
+  for(int offset = 0; offset < numFrames; offset += maxBlockSize)
+  {
+    renderBlock(tmp, std::min(numFrames-offset, maxBlockSize));
+    for(int v = 0; v < numLanes; v++)
+      tmp[v] += maxBlockSize;
+  }
+}
+
+template<int numLanes>
+void Open303xN<numLanes>::processBlock(float* const* out, int numFrames)
+{
+  float* tmp[numLanes];
+  for(int v = 0; v < numLanes; v++)
+    tmp[v] = out[v];
+  for(int offset = 0; offset < numFrames; offset += maxBlockSize)
+  {
+    renderBlock(tmp, std::min(numFrames-offset, maxBlockSize));
+    for(int v = 0; v < numLanes; v++)
+      tmp[v] += maxBlockSize;
+  }
+}
+
+template<int numLanes>
+template<class T>
+void Open303xN<numLanes>::renderBlock(T* const* out, int numFrames)
+{
+  int  n, v;
+  bool anyActive = false;
+  for(v = 0; v < numLanes; v++)
+  {
+    active[v] =    !voices[v].idle && voices[v].filter.mode == TeeBeeFilter::TB_303
+                && voices[v].oversampling == oversampling && voices[v].numDecimatorStages == 0
+                && voices[v].oscillator.getAlgorithm() == BlendOscillator::MIP_MAP
+                && voices[v].rampCounters[Open303::WAVEFORM] == 0 
+                && voices[v].rampCounters[Open303::VOLUME]   == 0;
+    if( active[v] )
+      anyActive = true;
+    else
+      voices[v].renderBlock(out[v], numFrames);
+  }
+  if( !anyActive )
+    return;
+
+  renderControlSignals(numFrames);
+  gatherStates();
+  renderLanes(numFrames);
+  scatterStates();
+
+  for(v = 0; v < numLanes; v++)
+  {
+    if( !active[v] )
+      continue;
+    double peak = 0.0;
+    for(n = 0; n < numFrames; n++)
+    {
+      out[v][n] = (T) (signalBuffer[n][v] * ampBuffer[n][v] * ampScaler[v]);
+      peak      = rmax(peak, fabs((double) out[v][n]));
+    }
+    voices[v].updateIdleState(peak, numFrames);
+  }
+}
+
+template<int numLanes>
+void Open303xN<numLanes>::renderControlSignals(int numFrames)
+{
+  for(int v = 0; v < numLanes; v++)
+  {
+    if( !active[v] )
+    {
+      // inactive lanes run along on harmless values and are discarded afterwards:
+      for(int n = 0; n < numFrames; n++)
+      {
+        incrementBuffer[n][v] = b0Buffer[n][v] = kBuffer[n][v] = gBuffer[n][v] = 0.0;
+        ampBuffer[n][v] = 0.0;
+      }
+      continue;
+    }
+
+    Open303 &voice = voices[v];
+    voice.renderControlSignals(numFrames);
+    voice.applyCutoffModulation(numFrames, [&](int n)
+    {
+      incrementBuffer[n][v] = voice.incrementBuffer[n];
+      b0Buffer[n][v]        = voice.filter.b0;
+      kBuffer[n][v]         = voice.filter.k;
+      gBuffer[n][v]         = voice.filter.g;
+      ampBuffer[n][v]       = voice.ampBuffer[n];
+    });
+  }
+}
+
+template<int numLanes>
+void Open303xN<numLanes>::gatherStates()
+{
+  for(int v = 0; v < numLanes; v++)
+  {
+    Open303 &voice = voices[v];
+
+    phaseIndex[v]  = voice.oscillator.phaseIndex;
+    tableLength[v] = voice.oscillator.tableLengthDbl;
+    blend[v]       = voice.oscillator.blend;
+
+    hp1B0[v] = voice.highpass1.b0;  hp1B1[v] = voice.highpass1.b1;  hp1A1[v] = voice.highpass1.a1;
+    hp1X1[v] = voice.highpass1.x1;  hp1Y1[v] = voice.highpass1.y1;
+
+    OnePoleFilter &fb = voice.filter.feedbackHighpass;
+    fbB0[v] = fb.b0;  fbB1[v] = fb.b1;  fbA1[v] = fb.a1;  fbX1[v] = fb.x1;  fbY1[v] = fb.y1;
+
+    y1[v] = voice.filter.y1;  y2[v] = voice.filter.y2;
+    y3[v] = voice.filter.y3;  y4[v] = voice.filter.y4;
+
+    for(int i = 0; i < 12; i++)
+      w[i][v] = voice.antiAliasFilter.w[i];
+
+    OnePoleFilter &ap  = voice.postFilters.allpass;
+    OnePoleFilter &hp2 = voice.postFilters.highpass;
+    apB0[v]  = ap.b0;   apB1[v]  = ap.b1;   apA1[v]  = ap.a1;   apX1[v]  = ap.x1;   apY1[v]  = ap.y1;
+    hp2B0[v] = hp2.b0;  hp2B1[v] = hp2.b1;  hp2A1[v] = hp2.a1;  hp2X1[v] = hp2.x1;  hp2Y1[v] = hp2.y1;
+
+    BiquadFilter &notch = voice.postFilters.notch;
+    nB0[v] = notch.b0;  nB1[v] = notch.b1;  nB2[v] = notch.b2;
+    nA1[v] = notch.a1;  nA2[v] = notch.a2;
+    nX1[v] = notch.x1;  nX2[v] = notch.x2;
+    nY1[v] = notch.y1;  nY2[v] = notch.y2;
+
+    ampScaler[v] = voice.ampScaler;
+  }
+}
+
+template<int numLanes>
+void Open303xN<numLanes>::scatterStates()
+{
+  for(int v = 0; v < numLanes; v++)
+  {
+    if( !active[v] )
+      continue;
+    Open303 &voice = voices[v];
+
+    voice.oscillator.phaseIndex = phaseIndex[v];
+
+    voice.highpass1.x1 = hp1X1[v];
+    voice.highpass1.y1 = hp1Y1[v];
+    voice.filter.feedbackHighpass.x1 = fbX1[v];
+    voice.filter.feedbackHighpass.y1 = fbY1[v];
+    voice.filter.y1 = y1[v];
+    voice.filter.y2 = y2[v];
+    voice.filter.y3 = y3[v];
+    voice.filter.y4 = y4[v];
+    for(int i = 0; i < 12; i++)
+      voice.antiAliasFilter.w[i] = w[i][v];
+
+    voice.postFilters.allpass.x1  = apX1[v];
+    voice.postFilters.allpass.y1  = apY1[v];
+    voice.postFilters.highpass.x1 = hp2X1[v];
+    voice.postFilters.highpass.y1 = hp2Y1[v];
+    voice.postFilters.notch.x1 = nX1[v];
+    voice.postFilters.notch.x2 = nX2[v];
+    voice.postFilters.notch.y1 = nY1[v];
+    voice.postFilters.notch.y2 = nY2[v];
+  }
+}
+
+template<int numLanes>
+void Open303xN<numLanes>::renderLanes(int numFrames)
+{
+  switch( CpuDispatch::getInstructionSet() )
+  {
+  case CpuDispatch::AVX512: renderLanesAvx512(numFrames); break;
+  case CpuDispatch::AVX2:   renderLanesAvx2(numFrames);   break;
+  default:                  renderLanesKernel(numFrames);
+  }
+}
+
+template<int numLanes>
+O303_TARGET_AVX2 void Open303xN<numLanes>::renderLanesAvx2(int numFrames)
+{
+  renderLanesKernel(numFrames);
+}
+
+template<int numLanes>
+O303_TARGET_AVX512 void Open303xN<numLanes>::renderLanesAvx512(int numFrames)
+{
+  renderLanesKernel(numFrames);
+}
+
+template<int numLanes>
+O303_KERNEL_INLINE void Open303xN<numLanes>::renderLanesKernel(int numFrames)
+{
+  // the per sample calculations are the ones of the instances' objects, applied to the lanes:
+  typedef EllipticQuarterBandFilter E;
+  double x[numLanes], u[numLanes];
+  int v;
+
+  for(int n = 0; n < numFrames; n++)
+  {
+    // select the mip-map level per lane:
+    for(v = 0; v < numLanes; v++)
+    {
+      tableIndex[v] = BlendOscillator::getTableNumber(incrementBuffer[n][v]);
+      table1[v]     = voices[v].waveTable1.tableSet[tableIndex[v]];
+      table2[v]     = voices[v].waveTable2.tableSet[tableIndex[v]];
+    }
+
+    for(int i = 1; i <= oversampling; i++)
+    {
+      // oscillator - the table lookups are gathers and stay scalar:
+      for(v = 0; v < numLanes; v++)
+        x[v] = -BlendOscillator::processSample(table1[v], table2[v], tableIndex[v], blend[v],
+                                               incrementBuffer[n][v], tableLength[v], 
+                                               phaseIndex[v]);
+
+      // pre-filter highpass and TB_303 filter:
+      for(v = 0; v < numLanes; v++)
+      {
+        double in = OnePoleFilter::processSample(x[v], hp1B0[v], hp1B1[v], hp1A1[v], 
+                                                 hp1X1[v], hp1Y1[v]);
+        double fb = OnePoleFilter::processSample(kBuffer[n][v] * TeeBeeFilter::shape(y4[v]), 
+                                                 fbB0[v], fbB1[v], fbA1[v], fbX1[v], fbY1[v]);
+        x[v] = TeeBeeFilter::processLadderTB303(in, fb, b0Buffer[n][v], gBuffer[n][v], 
+                                                y1[v], y2[v], y3[v], y4[v]);
+      }
+
+      // anti-aliasing filter on the interleaved state buffers:
+      for(v = 0; v < numLanes; v++)
+        u[v] = E::processSample<numLanes>(x[v], &w[0][v], x[v]);
+      memmove(&w[1][0], &w[0][0], 11*numLanes*sizeof(double));
+      for(v = 0; v < numLanes; v++)
+        w[0][v] = x[v];
+    }
+
+    // the filters that run without oversampling:
+    for(v = 0; v < numLanes; v++)
+    {
+      double y = OnePoleFilter::processSample(u[v], apB0[v], apB1[v], apA1[v], apX1[v], apY1[v]);
+      y = OnePoleFilter::processSample(y, hp2B0[v], hp2B1[v], hp2A1[v], hp2X1[v], hp2Y1[v]);
+      signalBuffer[n][v] = BiquadFilter::processSample(y, nB0[v], nB1[v], nB2[v], nA1[v], nA2[v],
+                                                       nX1[v], nX2[v], nY1[v], nY2[v]);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::Open303xN<4>;
+template class rosic::Open303xN<8>;
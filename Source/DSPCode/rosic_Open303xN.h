@@ -0,0 +1,132 @@
+#ifndef rosic_Open303xN_h
+#define rosic_Open303xN_h
+
+#include "rosic_Open303.h"
+
+namespace rosic
+{
+
+  /**
+
+  This class renders numLanes independent Open303 instances in lockstep. The control-rate part
+  (sequencer, pitch-slew, envelopes, cutoff modulation) runs per instance inside the embedded
+  Open303 objects. The audio-rate part (oscillator, pre-filter highpass, TB_303 filter,
+  anti-aliasing filter and the post filters) runs on a structure-of-arrays copy of the instances'
+  states where each instance occupies one lane. The lane loops have a fixed trip count and no
+  dependencies between the lanes, so the compiler can map them onto the vector instruction set of
+  the target (SSE2, AVX2, NEON, ...) - only the wavetable lookups remain scalar. On x86, the lane
+  loops are compiled for AVX2 and AVX-512 as well and the variant is selected at runtime
+  (@see CpuDispatch).
+
+  The output of each lane is identical to what the instance would produce with its own
+  Open303::processBlock. Instances that are idle, whose filter is not in TB_303 mode, that use
+  another oversampling factor than 4 or another anti-aliasing filter than the elliptic one, that
+  use the POLY_BLEP oscillator or whose waveform or volume is ramping
+  (@see Open303::setParameterSmoothly) are rendered individually. Instantiations exist for 4 and 8
+  lanes (Open303x4, Open303x8).
+
+  */
+
+  template<int numLanes>
+  class Open303xN
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    Open303xN();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate for all instances. */
+    void setSampleRate(double newSampleRate);
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Calculates a block of output samples for all instances where out[i] points to the buffer
+    for instance i. */
+    void processBlock(double* const* out, int numFrames);
+
+    /** Single precision version of processBlock. */
+    void processBlock(float* const* out, int numFrames);
+
+    //---------------------------------------------------------------------------------------------
+    // embedded objects:
+
+    /** The instances - set up their parameters and send them notes as usual. */
+    Open303 voices[numLanes];
+
+    //=============================================================================================
+
+  protected:
+
+    /** Renders a sub-block of at most maxBlockSize samples - called from processBlock. */
+    template<class T>
+    void renderBlock(T* const* out, int numFrames);
+
+    /** Runs the control-rate part of the active instances and collects the per sample phase
+    increments, filter coefficients and amplitudes into the lane buffers. */
+    void renderControlSignals(int numFrames);
+
+    /** Copies the audio-rate states and coefficients of all instances into the lanes. */
+    void gatherStates();
+
+    /** Copies the audio-rate states of the active lanes back into their instances. */
+    void scatterStates();
+
+    /** Runs the oversampled part and the post filters for all lanes with the variant for the
+    selected instruction set (@see CpuDispatch). */
+    void renderLanes(int numFrames);
+
+    /** The implementation of renderLanes and its variants for the instruction sets. */
+    O303_KERNEL_INLINE void renderLanesKernel(int numFrames);
+    O303_TARGET_AVX2   void renderLanesAvx2(int numFrames);
+    O303_TARGET_AVX512 void renderLanesAvx512(int numFrames);
+
+    static const int oversampling = 4;
+    static constexpr int maxBlockSize = Open303::maxBlockSize;
+
+    bool active[numLanes]; // lanes that are rendered here (as opposed to individually)
+
+    // oscillator:
+    double phaseIndex[numLanes], tableLength[numLanes], blend[numLanes];
+    const double *table1[numLanes], *table2[numLanes];
+    int tableIndex[numLanes];
+
+    // pre-filter highpass, feedback highpass, allpass and post-filter highpass (one-poles):
+    double hp1B0[numLanes], hp1B1[numLanes], hp1A1[numLanes], hp1X1[numLanes], hp1Y1[numLanes];
+    double fbB0[numLanes],  fbB1[numLanes],  fbA1[numLanes],  fbX1[numLanes],  fbY1[numLanes];
+    double apB0[numLanes],  apB1[numLanes],  apA1[numLanes],  apX1[numLanes],  apY1[numLanes];
+    double hp2B0[numLanes], hp2B1[numLanes], hp2A1[numLanes], hp2X1[numLanes], hp2Y1[numLanes];
+
+    // notch (biquad):
+    double nB0[numLanes], nB1[numLanes], nB2[numLanes], nA1[numLanes], nA2[numLanes];
+    double nX1[numLanes], nX2[numLanes], nY1[numLanes], nY2[numLanes];
+
+    // filter stages and anti-aliasing filter state:
+    double y1[numLanes], y2[numLanes], y3[numLanes], y4[numLanes];
+    double w[12][numLanes];
+
+    double ampScaler[numLanes];
+
+    // per sample control signals and output signal, sample-major with the lanes side by side:
+    double incrementBuffer[maxBlockSize][numLanes];
+    double b0Buffer[maxBlockSize][numLanes];
+    double kBuffer[maxBlockSize][numLanes];
+    double gBuffer[maxBlockSize][numLanes];
+    double ampBuffer[maxBlockSize][numLanes];
+    double signalBuffer[maxBlockSize][numLanes];
+
+  };
+
+  typedef Open303xN<4> Open303x4;
+  typedef Open303xN<8> Open303x8;
+
+}
+
+#endif
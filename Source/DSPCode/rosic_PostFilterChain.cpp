@@ -0,0 +1,124 @@
+#include "rosic_PostFilterChain.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+template<class T>
+PostFilterChainT<T>::PostFilterChainT()
+{
+  allpass.setMode(OnePoleFilterT<T>::ALLPASS);
+  highpass.setMode(OnePoleFilterT<T>::HIGHPASS);
+  notch.setMode(BiquadFilter::BANDREJECT);
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+template<class T>
+void PostFilterChainT<T>::setSampleRate(double newSampleRate)
+{
+  allpass.setSampleRate(newSampleRate);
+  highpass.setSampleRate(newSampleRate);
+  notch.setSampleRate(newSampleRate);
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+template<class T>
+template<class TOut>
+O303_KERNEL_INLINE void PostFilterChainT<T>::processBlockKernel(T *buffer, const double *amp,
+  const double *gain, double constantGain, TOut *out, int numSamples)
+{
+  // the filters run on local copies of their coefficients and states:
+  const T apB0 = allpass.b0,  apB1 = allpass.b1,  apA1 = allpass.a1;
+  const T hpB0 = highpass.b0, hpB1 = highpass.b1, hpA1 = highpass.a1;
+  const double nB0 = notch.b0, nB1 = notch.b1, nB2 = notch.b2, nA1 = notch.a1, nA2 = notch.a2;
+  T      apX1 = allpass.x1,  apY1 = allpass.y1;
+  T      hpX1 = highpass.x1, hpY1 = highpass.y1;
+  double nX1  = notch.x1, nX2 = notch.x2, nY1 = notch.y1, nY2 = notch.y2;
+  T      x;
+  int    n;
+  for(n = 0; n < numSamples; n++)
+  {
+    x = OnePoleFilterT<T>::processSample(buffer[n], apB0, apB1, apA1, apX1, apY1);
+    x = OnePoleFilterT<T>::processSample(x,         hpB0, hpB1, hpA1, hpX1, hpY1);
+    buffer[n] = (T) BiquadFilter::processSample(x, nB0, nB1, nB2, nA1, nA2, nX1, nX2, nY1, nY2);
+  }
+  allpass.x1  = apX1; allpass.y1  = apY1;
+  highpass.x1 = hpX1; highpass.y1 = hpY1;
+  notch.x1    = nX1;  notch.x2    = nX2;  notch.y1 = nY1;  notch.y2 = nY2;
+
+  // the gains:
+  if( gain != nullptr )
+  {
+    for(n = 0; n < numSamples; n++)
+      out[n] = (TOut) (buffer[n] * amp[n] * gain[n]);
+  }
+  else
+  {
+    for(n = 0; n < numSamples; n++)
+      out[n] = (TOut) (buffer[n] * amp[n] * constantGain);
+  }
+}
+
+template<class T>
+template<class TOut>
+void PostFilterChainT<T>::processBlock(T *buffer, const double *amp, const double *gain,
+                                       double constantGain, TOut *out, int numSamples)
+{
+  switch( CpuDispatch::getInstructionSet() )
+  {
+  case CpuDispatch::AVX512:
+    processBlockAvx512(buffer, amp, gain, constantGain, out, numSamples);
+    break;
+  case CpuDispatch::AVX2:
+    processBlockAvx2(buffer, amp, gain, constantGain, out, numSamples);
+    break;
+  default:
+    processBlockKernel(buffer, amp, gain, constantGain, out, numSamples);
+  }
+}
+
+template<class T>
+template<class TOut>
+O303_TARGET_AVX2 void PostFilterChainT<T>::processBlockAvx2(T *buffer, const double *amp,
+  const double *gain, double constantGain, TOut *out, int numSamples)
+{
+  processBlockKernel(buffer, amp, gain, constantGain, out, numSamples);
+}
+
+template<class T>
+template<class TOut>
+O303_TARGET_AVX512 void PostFilterChainT<T>::processBlockAvx512(T *buffer, const double *amp,
+  const double *gain, double constantGain, TOut *out, int numSamples)
+{
+  processBlockKernel(buffer, amp, gain, constantGain, out, numSamples);
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+template<class T>
+void PostFilterChainT<T>::reset()
+{
+  allpass.reset();
+  highpass.reset();
+  notch.reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::PostFilterChainT<double>;
+template class rosic::PostFilterChainT<float>;
+
+template void PostFilterChainT<double>::processBlock<double>(double *buffer, const double *amp,
+  const double *gain, double constantGain, double *out, int numSamples);
+template void PostFilterChainT<double>::processBlock<float>(double *buffer, const double *amp,
+  const double *gain, double constantGain, float *out, int numSamples);
+template void PostFilterChainT<float>::processBlock<double>(float *buffer, const double *amp,
+  const double *gain, double constantGain, double *out, int numSamples);
+template void PostFilterChainT<float>::processBlock<float>(float *buffer, const double *amp,
+  const double *gain, double constantGain, float *out, int numSamples);
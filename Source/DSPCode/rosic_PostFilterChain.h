@@ -0,0 +1,117 @@
+#ifndef rosic_PostFilterChain_h
+#define rosic_PostFilterChain_h
+
+// rosic-indcludes:
+#include "rosic_OnePoleFilter.h"
+#include "rosic_BiquadFilter.h"
+#include "rosic_CpuDispatch.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is the chain of filters after the decimation of Open303: an allpass, a highpass and a
+  notch, followed by the amplitude envelope and the volume. getSample runs the filters one after
+  another, processBlock runs them in a single loop with the coefficients and states in local
+  variables (such that the three recursions overlap instead of each one waiting for its own
+  previous output) and applies the gains in a second, vectorizable loop. Both give the same
+  output to the last bit - the filters are not combined into one higher order filter because that
+  would change the rounding. The notch always runs in double precision (@see Open303T).
+
+  */
+
+  template<class T>
+  class PostFilterChainT
+  {
+
+    template<int numLanes> friend class Open303xN; // copies coefficients and states
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    PostFilterChainT();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate (in Hz) at which the filters run. */
+    void setSampleRate(double newSampleRate);
+
+    /** Sets the cutoff frequency of the allpass in Hz. */
+    void setAllpassCutoff(double newCutoff) { allpass.setCutoff(newCutoff); }
+
+    /** Sets the cutoff frequency of the highpass in Hz. */
+    void setHighpassCutoff(double newCutoff) { highpass.setCutoff(newCutoff); }
+
+    /** Sets the center frequency of the notch in Hz. */
+    void setNotchFrequency(double newFrequency) { notch.setFrequency(newFrequency); }
+
+    /** Sets the bandwidth of the notch in octaves. */
+    void setNotchBandwidth(double newBandwidth) { notch.setBandwidth(newBandwidth); }
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the cutoff frequency of the highpass in Hz. */
+    double getHighpassCutoff() const { return highpass.getCutoff(); }
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Calculates a single filtered output-sample (without the gains). */
+    INLINE T getSample(T in);
+
+    /** Filters the buffer in place and writes the filtered signal multiplied by the amplitude
+    envelope and the gain into the output (as out[n] = (TOut) (buffer[n] * amp[n] * gain[n]) in
+    double precision). When gain is a null pointer, the constantGain is used for all samples. */
+    template<class TOut>
+    void processBlock(T *buffer, const double *amp, const double *gain, double constantGain,
+                      TOut *out, int numSamples);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Resets the states of the filters to zero. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** The implementation of processBlock and its variants for the instruction sets, processBlock
+    dispatches to them (@see CpuDispatch). */
+    template<class TOut>
+    O303_KERNEL_INLINE void processBlockKernel(T *buffer, const double *amp, const double *gain,
+                                               double constantGain, TOut *out, int numSamples);
+    template<class TOut>
+    O303_TARGET_AVX2 void processBlockAvx2(T *buffer, const double *amp, const double *gain,
+                                           double constantGain, TOut *out, int numSamples);
+    template<class TOut>
+    O303_TARGET_AVX512 void processBlockAvx512(T *buffer, const double *amp, const double *gain,
+                                               double constantGain, TOut *out, int numSamples);
+
+    OnePoleFilterT<T> allpass, highpass;
+    BiquadFilter      notch;
+
+  };
+
+  //-----------------------------------------------------------------------------------------------
+  // inlined functions:
+
+  template<class T>
+  INLINE T PostFilterChainT<T>::getSample(T in)
+  {
+    T tmp = allpass.getSample(in);
+    tmp   = highpass.getSample(tmp);
+    return (T) notch.getSample(tmp);
+  }
+
+  typedef PostFilterChainT<double> PostFilterChain;
+
+} // end namespace rosic
+
+#endif // rosic_PostFilterChain_h
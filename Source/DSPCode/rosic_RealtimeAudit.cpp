@@ -0,0 +1,466 @@
+#include "rosic_RealtimeAudit.h"
+
+#ifdef O303_RT_AUDIT
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+// the original allocation functions of glibc:
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void *ptr, size_t size);
+extern "C" void  __libc_free(void *ptr);
+#endif
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define RT_AUDIT_HAS_BACKTRACE 1
+#endif
+
+// the thread-locals are accessed inside malloc, so they must not be allocated lazily (which glibc
+// does in dynamically loaded libraries unless they use the initial-exec model):
+#if defined(__GNUC__) && !defined(_WIN32)
+#define RT_AUDIT_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define RT_AUDIT_TLS
+#endif
+
+using namespace rosic;
+
+namespace
+{
+
+  thread_local int  audioPathDepth RT_AUDIT_TLS = 0;     // number of active AudioThreadScopes
+  thread_local bool isRecording    RT_AUDIT_TLS = false; // to ignore the tripwires of the recording
+
+  std::atomic<long long> numViolations(0);
+
+  /**
+
+  The log of the violations - a ring buffer that is written by any number of audio threads and
+  read by the reporter thread. Each slot is protected by a sequence number like a seqlock, so
+  neither side ever waits. When the reporter falls behind by more than the capacity, the oldest
+  violations are overwritten and counted as lost.
+
+  */
+
+  class ViolationLog
+  {
+
+  public:
+
+    static const int capacity  = 64;
+    static const int maxFrames = 32;
+
+    struct Violation
+    {
+      const char *description;
+      int         numFrames;
+      void       *frames[maxFrames];
+    };
+
+    /** Records a violation with the call stack of the current thread. */
+    void push(const char *description)
+    {
+      unsigned int index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+      Slot &slot = slots[index % capacity];
+      slot.sequence.store(0, std::memory_order_relaxed); // marks the slot as being written
+      std::atomic_thread_fence(std::memory_order_release);
+      slot.violation.description = description;
+#ifdef RT_AUDIT_HAS_BACKTRACE
+      slot.violation.numFrames = backtrace(slot.violation.frames, maxFrames);
+#else
+      slot.violation.numFrames = 0;
+#endif
+      slot.sequence.store(index+1, std::memory_order_release);
+    }
+
+    /** Retrieves the oldest violation that hasn't been read yet, returns false if there is none.
+    The number of violations that were overwritten before they could be read is added to
+    numLost. */
+    bool pop(Violation &violation, unsigned int &numLost)
+    {
+      while( true )
+      {
+        Slot &slot = slots[readIndex % capacity];
+        unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+        if( sequence == 0 || sequence-1 < readIndex )
+          return false; // not written yet or still being written
+        violation = slot.violation;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if( slot.sequence.load(std::memory_order_relaxed) != sequence )
+          continue; // overwritten while we were reading
+        numLost  += sequence-1 - readIndex;
+        readIndex = sequence;
+        return true;
+      }
+    }
+
+  protected:
+
+    struct Slot
+    {
+      std::atomic<unsigned int> sequence; // index+1 of the violation in the slot (0 while written)
+      Violation violation;
+    };
+
+    Slot slots[capacity];
+    std::atomic<unsigned int> writeIndex;
+    unsigned int readIndex;   // owned by the reporter thread
+
+  };
+
+  ViolationLog violationLog; // zero-initialized, so it can be used before the static constructors
+
+  /**
+
+  The background thread that prints the violations to stderr. It polls the log, so the audio
+  threads don't need to notify it (which would be a system call).
+
+  */
+
+  class ViolationReporter
+  {
+
+  public:
+
+    ViolationReporter() : quit(false)
+    {
+#ifdef RT_AUDIT_HAS_BACKTRACE
+      // the first call loads the unwinder, which must not happen on the audio thread:
+      void *frames[ViolationLog::maxFrames];
+      backtrace(frames, ViolationLog::maxFrames);
+#endif
+      thread = std::thread(&ViolationReporter::run, this);
+    }
+
+    ~ViolationReporter()
+    {
+      quit = true;
+      thread.join();
+      report();
+    }
+
+  protected:
+
+    void run()
+    {
+      while( !quit )
+      {
+        report();
+        std::this_thread::sleep_for(std::chrono::milliseconds(pollingInterval));
+      }
+    }
+
+    void report()
+    {
+      ViolationLog::Violation violation;
+      unsigned int numLost = 0;
+      while( violationLog.pop(violation, numLost) )
+      {
+        std::fprintf(stderr, "open303 realtime audit: %s on the audio thread\n",
+          violation.description);
+#ifdef RT_AUDIT_HAS_BACKTRACE
+        std::fflush(stderr);
+        backtrace_symbols_fd(violation.frames, violation.numFrames, 2);
+#endif
+      }
+      if( numLost > 0 )
+        std::fprintf(stderr, "open303 realtime audit: %u violations were not logged\n", numLost);
+    }
+
+    static constexpr int pollingInterval = 100; // in milliseconds
+
+    std::atomic<bool> quit;
+    std::thread       thread;
+
+  };
+
+  ViolationReporter violationReporter;
+
+  //-----------------------------------------------------------------------------------------------
+  // the allocation functions that are used by the tripwires themselves:
+
+#if defined(__GLIBC__)
+  void* allocate(size_t size)  { return __libc_malloc(size > 0 ? size : 1); }
+  void  deallocate(void *ptr)  { __libc_free(ptr); }
+#else
+  void* allocate(size_t size)  { return std::malloc(size > 0 ? size : 1); }
+  void  deallocate(void *ptr)  { std::free(ptr); }
+#endif
+
+}
+
+//-------------------------------------------------------------------------------------------------
+// RealtimeAudit:
+
+RealtimeAudit::AudioThreadScope::AudioThreadScope(bool isRealtime) : active(isRealtime)
+{
+  if( active )
+    audioPathDepth++;
+}
+
+RealtimeAudit::AudioThreadScope::~AudioThreadScope()
+{
+  if( active )
+    audioPathDepth--;
+}
+
+long long RealtimeAudit::getNumViolations()
+{
+  return numViolations.load(std::memory_order_relaxed);
+}
+
+void RealtimeAudit::checkpoint(const char *description)
+{
+  if( audioPathDepth == 0 || isRecording )
+    return;
+  isRecording = true;
+  numViolations.fetch_add(1, std::memory_order_relaxed);
+  violationLog.push(description);
+  isRecording = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// tripwires for the allocations:
+
+void* operator new(std::size_t size)
+{
+  RealtimeAudit::checkpoint("operator new");
+  if( void *ptr = allocate(size) )
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+  RealtimeAudit::checkpoint("operator new[]");
+  if( void *ptr = allocate(size) )
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  RealtimeAudit::checkpoint("operator new");
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  RealtimeAudit::checkpoint("operator new[]");
+  return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  if( ptr != nullptr )
+    RealtimeAudit::checkpoint("operator delete");
+  deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  if( ptr != nullptr )
+    RealtimeAudit::checkpoint("operator delete[]");
+  deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  operator delete[](ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t&) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept
+{
+  operator delete[](ptr);
+}
+
+#if defined(__GLIBC__)
+
+//-------------------------------------------------------------------------------------------------
+// tripwires for the C allocation functions, locks and blocking system calls (glibc only - these
+// replace the library functions, the original ones are looked up with dlsym):
+
+namespace
+{
+
+  template<class Function, class Replacement>
+  Function lookUp(Function &original, const char *name, Replacement replacement)
+  {
+    // RTLD_NEXT finds nothing when we are in a library that was loaded after libc:
+    if( original == nullptr )
+    {
+      void *function = dlsym(RTLD_NEXT, name);
+      if( function == nullptr || function == (void*) replacement )
+        function = dlsym(RTLD_DEFAULT, name);
+      if( function == nullptr || function == (void*) replacement )
+        std::abort();
+      original = (Function) function;
+    }
+    return original;
+  }
+
+  int (*originalMutexLock)(pthread_mutex_t*);
+  int (*originalRwlockRdlock)(pthread_rwlock_t*);
+  int (*originalRwlockWrlock)(pthread_rwlock_t*);
+  int (*originalCondWait)(pthread_cond_t*, pthread_mutex_t*);
+  int (*originalCondTimedwait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+  int (*originalSemWait)(sem_t*);
+  int (*originalNanosleep)(const struct timespec*, struct timespec*);
+  int (*originalClockNanosleep)(clockid_t, int, const struct timespec*, struct timespec*);
+  int (*originalUsleep)(useconds_t);
+  ssize_t (*originalRead)(int, void*, size_t);
+  ssize_t (*originalWrite)(int, const void*, size_t);
+
+}
+
+extern "C"
+{
+
+  void* malloc(size_t size) noexcept
+  {
+    RealtimeAudit::checkpoint("malloc");
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t count, size_t size) noexcept
+  {
+    RealtimeAudit::checkpoint("calloc");
+    return __libc_calloc(count, size);
+  }
+
+  void* realloc(void *ptr, size_t size) noexcept
+  {
+    RealtimeAudit::checkpoint("realloc");
+    return __libc_realloc(ptr, size);
+  }
+
+  void free(void *ptr) noexcept
+  {
+    if( ptr != nullptr )
+      RealtimeAudit::checkpoint("free");
+    __libc_free(ptr);
+  }
+
+  int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept
+  {
+    RealtimeAudit::checkpoint("pthread_mutex_lock");
+    return lookUp(originalMutexLock, "pthread_mutex_lock", &pthread_mutex_lock)(mutex);
+  }
+
+  int pthread_rwlock_rdlock(pthread_rwlock_t *lock) noexcept
+  {
+    RealtimeAudit::checkpoint("pthread_rwlock_rdlock");
+    return lookUp(originalRwlockRdlock, "pthread_rwlock_rdlock", &pthread_rwlock_rdlock)(lock);
+  }
+
+  int pthread_rwlock_wrlock(pthread_rwlock_t *lock) noexcept
+  {
+    RealtimeAudit::checkpoint("pthread_rwlock_wrlock");
+    return lookUp(originalRwlockWrlock, "pthread_rwlock_wrlock", &pthread_rwlock_wrlock)(lock);
+  }
+
+  int pthread_cond_wait(pthread_cond_t *condition, pthread_mutex_t *mutex)
+  {
+    RealtimeAudit::checkpoint("pthread_cond_wait");
+    return lookUp(originalCondWait, "pthread_cond_wait", &pthread_cond_wait)(condition, mutex);
+  }
+
+  int pthread_cond_timedwait(pthread_cond_t *condition, pthread_mutex_t *mutex,
+                             const struct timespec *time)
+  {
+    RealtimeAudit::checkpoint("pthread_cond_timedwait");
+    return lookUp(originalCondTimedwait, "pthread_cond_timedwait", &pthread_cond_timedwait)(
+      condition, mutex, time);
+  }
+
+  int sem_wait(sem_t *semaphore)
+  {
+    RealtimeAudit::checkpoint("sem_wait");
+    return lookUp(originalSemWait, "sem_wait", &sem_wait)(semaphore);
+  }
+
+  int nanosleep(const struct timespec *duration, struct timespec *remaining)
+  {
+    RealtimeAudit::checkpoint("nanosleep");
+    return lookUp(originalNanosleep, "nanosleep", &nanosleep)(duration, remaining);
+  }
+
+  int clock_nanosleep(clockid_t clock, int flags, const struct timespec *time,
+                      struct timespec *remaining)
+  {
+    RealtimeAudit::checkpoint("clock_nanosleep");
+    return lookUp(originalClockNanosleep, "clock_nanosleep", &clock_nanosleep)(
+      clock, flags, time, remaining);
+  }
+
+  int usleep(useconds_t duration)
+  {
+    RealtimeAudit::checkpoint("usleep");
+    return lookUp(originalUsleep, "usleep", &usleep)(duration);
+  }
+
+  ssize_t read(int file, void *buffer, size_t size)
+  {
+    RealtimeAudit::checkpoint("read");
+    return lookUp(originalRead, "read", &read)(file, buffer, size);
+  }
+
+  ssize_t write(int file, const void *buffer, size_t size)
+  {
+    RealtimeAudit::checkpoint("write");
+    return lookUp(originalWrite, "write", &write)(file, buffer, size);
+  }
+
+}
+
+namespace
+{
+
+  // looks the original functions up at load time, so that dlsym isn't called on the audio thread:
+  struct OriginalsLookUp
+  {
+    OriginalsLookUp()
+    {
+      lookUp(originalMutexLock,      "pthread_mutex_lock",     &pthread_mutex_lock);
+      lookUp(originalRwlockRdlock,   "pthread_rwlock_rdlock",  &pthread_rwlock_rdlock);
+      lookUp(originalRwlockWrlock,   "pthread_rwlock_wrlock",  &pthread_rwlock_wrlock);
+      lookUp(originalCondWait,       "pthread_cond_wait",      &pthread_cond_wait);
+      lookUp(originalCondTimedwait,  "pthread_cond_timedwait", &pthread_cond_timedwait);
+      lookUp(originalSemWait,        "sem_wait",               &sem_wait);
+      lookUp(originalNanosleep,      "nanosleep",              &nanosleep);
+      lookUp(originalClockNanosleep, "clock_nanosleep",        &clock_nanosleep);
+      lookUp(originalUsleep,         "usleep",                 &usleep);
+      lookUp(originalRead,           "read",                   &read);
+      lookUp(originalWrite,          "write",                  &write);
+    }
+
+  } originalsLookUp;
+
+}
+
+#endif // defined(__GLIBC__)
+
+#endif // O303_RT_AUDIT
@@ -0,0 +1,80 @@
+#ifndef rosic_RealtimeAudit_h
+#define rosic_RealtimeAudit_h
+
+namespace rosic
+{
+
+  /**
+
+  This is the realtime-safety audit mode for debug builds. When the library is compiled with
+  O303_RT_AUDIT defined (by the CMake option of the same name), it installs tripwires in the memory
+  allocation functions (operator new/delete and, with glibc, malloc, calloc, realloc and free), in
+  the lock functions and in the blocking system calls (sleeping, reading and writing) - the latter
+  two only with glibc. A tripwire fires when it is hit on a thread that is inside an
+  AudioThreadScope (the plug-in puts one around its process call). The violation is recorded
+  together with its call stack in a lock-free ring buffer and printed to stderr by a background
+  thread, so the reporting doesn't cause further violations on the audio thread.
+
+  Without O303_RT_AUDIT, no tripwires are installed and AudioThreadScope does nothing.
+
+  */
+
+  class RealtimeAudit
+  {
+
+  public:
+
+    /** Marks the current thread as being inside the audio path for the lifetime of the object.
+    Scopes can be nested. */
+    class AudioThreadScope
+    {
+    public:
+
+#ifdef O303_RT_AUDIT
+      /** Constructor. Pass false when the thread doesn't need to be realtime-safe this time
+      (for example for offline rendering). */
+      AudioThreadScope(bool isRealtime = true);
+
+      /** Destructor. */
+      ~AudioThreadScope();
+
+      AudioThreadScope(const AudioThreadScope&) = delete;
+      AudioThreadScope& operator=(const AudioThreadScope&) = delete;
+
+    protected:
+
+      bool active;
+#else
+      AudioThreadScope(bool /*isRealtime*/ = true) {}
+#endif
+
+    };
+
+    /** Returns true when the library was compiled with the tripwires. */
+    static constexpr bool isEnabled()
+    {
+#ifdef O303_RT_AUDIT
+      return true;
+#else
+      return false;
+#endif
+    }
+
+#ifdef O303_RT_AUDIT
+    /** Returns the number of violations since the start of the program. */
+    static long long getNumViolations();
+
+    /** Records a violation when the current thread is inside an AudioThreadScope - this is what
+    the tripwires call, but it can also be called from code that is not covered by them. The
+    description must be a string literal. */
+    static void checkpoint(const char *description);
+#else
+    static long long getNumViolations() { return 0; }
+    static void checkpoint(const char * /*description*/) {}
+#endif
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_RealtimeAudit_h
@@ -1,10 +1,14 @@
 #include "rosic_TeeBeeFilter.h"
+#include "rosic_FunctionTemplates.h"
+#include <map>
+#include <mutex>
 using namespace rosic;
 
 //-------------------------------------------------------------------------------------------------
 // construction/destruction:
 
-TeeBeeFilter::TeeBeeFilter()
+template<class T>
+TeeBeeFilterT<T>::TeeBeeFilterT()
 {
   cutoff              =  1000.0;
   drive               =     0.0;
@@ -12,8 +16,14 @@ TeeBeeFilter::TeeBeeFilter()
   resonanceRaw        =     0.0;
   resonanceSkewed     =     0.0;
   g                   =     1.0;
+  da1                 =     0.0;
+  db0                 =     0.0;
+  dk                  =     0.0;
+  dg                  =     0.0;
   sampleRate          = 44100.0;
   twoPiOverSampleRate = 2.0*PI/sampleRate;
+  maxCutoff           = 20000.0;
+  coefficientMode     = APPROXIMATION;
 
   feedbackHighpass.setMode(OnePoleFilter::HIGHPASS);
   feedbackHighpass.setCutoff(150.0);
@@ -24,7 +34,8 @@ TeeBeeFilter::TeeBeeFilter()
   reset();
 }
 
-TeeBeeFilter::~TeeBeeFilter()
+template<class T>
+TeeBeeFilterT<T>::~TeeBeeFilterT()
 {
 
 }
@@ -32,22 +43,33 @@ TeeBeeFilter::~TeeBeeFilter()
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void TeeBeeFilter::setSampleRate(double newSampleRate)
+template<class T>
+void TeeBeeFilterT<T>::setSampleRate(double newSampleRate)
 {
   if( newSampleRate > 0.0 )
     sampleRate = newSampleRate;
   twoPiOverSampleRate = 2.0*PI/sampleRate;
+
+  // calculateCoefficientsApprox4 diverges beyond wc = 1.5 which matters only for sample rates 
+  // below 4x44.1 kHz (i.e. reduced oversampling):
+  maxCutoff = rmin(20000.0, 1.5/twoPiOverSampleRate);
+  cutoff    = rmin(cutoff, maxCutoff);
+
   feedbackHighpass.setSampleRate(newSampleRate);
+  if( coefficientMode == LOOKUP_TABLE )
+    coefficientTable = createCoefficientTable(sampleRate);
   calculateCoefficientsExact();
 }
 
-void TeeBeeFilter::setDrive(double newDrive)
+template<class T>
+void TeeBeeFilterT<T>::setDrive(double newDrive)
 {
   drive       = newDrive;
   driveFactor = dB2amp(drive);
 }
 
-void TeeBeeFilter::setMode(int newMode)
+template<class T>
+void TeeBeeFilterT<T>::setMode(int newMode)
 {
   if( newMode >= 0 && newMode < NUM_MODES )
   {
@@ -72,13 +94,82 @@ void TeeBeeFilter::setMode(int newMode)
     default:        c0 =  1.0; c1 =  0.0; c2 =  0.0; c3 =  0.0; c4 =  0.0;  // flat
     }
   }
-  calculateCoefficientsApprox4();
+  calculateCoefficients();
+}
+
+template<class T>
+void TeeBeeFilterT<T>::setCoefficientMode(int newMode)
+{
+  if( newMode >= 0 && newMode < NUM_COEFFICIENT_MODES )
+  {
+    coefficientMode = newMode;
+    if( coefficientMode == LOOKUP_TABLE )
+      coefficientTable = createCoefficientTable(sampleRate);
+    else
+      coefficientTable = nullptr;
+  }
+  calculateCoefficients();
 }
 
 //-------------------------------------------------------------------------------------------------
 // others:
 
-void TeeBeeFilter::reset()
+template<class T>
+std::shared_ptr<const typename TeeBeeFilterT<T>::CoefficientTable> 
+TeeBeeFilterT<T>::createCoefficientTable(double sampleRate)
+{
+  // function-local, such that objects with static storage duration can use the cache safely:
+  static std::mutex cacheMutex;
+  static std::map<double, std::weak_ptr<const CoefficientTable>> cache;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  std::shared_ptr<const CoefficientTable> newTable = cache[sampleRate].lock();
+  if( newTable != nullptr )
+    return newTable;
+
+  // the same limits as in setSampleRate:
+  double twoPiOverSampleRate = 2.0*PI/sampleRate;
+  double maxCutoff           = rmin(20000.0, 1.5/twoPiOverSampleRate);
+
+  std::shared_ptr<CoefficientTable> tmp = std::make_shared<CoefficientTable>();
+  double (*coefficientTable)[4] = tmp->entries;
+  for(int i = 0; i < tableSize; i++)
+  {
+    // the cutoff of the entry (@see coefficientTable) - the ones above the maxCutoff are never 
+    // reached, they are limited such that the formulas don't break down:
+    UINT64 bits = tableMinCutoffBits + ((UINT64) i << tableFractionBits);
+    double fc;
+    memcpy(&fc, &bits, sizeof(fc));
+    double wc = twoPiOverSampleRate * rmin(fc, 2.0*maxCutoff);
+
+    // the formulas from calculateCoefficientsExact for full resonance:
+    double s, c;
+    sinCos(wc, &s, &c);
+    double t   = tan(0.25*(wc-PI));
+    double a1  = t / (s-c*t);
+    double b0  = 1.0+a1;
+    double gsq = b0*b0 / (1.0 + a1*a1 + 2.0*a1*c);
+    coefficientTable[i][0] = b0;
+    coefficientTable[i][1] = 1.0 / (gsq*gsq);
+
+    calculateTB303Coefficients(wc, &coefficientTable[i][2], &coefficientTable[i][3]);
+  }
+  newTable          = tmp;
+  cache[sampleRate] = newTable;
+
+  // clean up entries of tables that are not used anymore:
+  for(auto it = cache.begin(); it != cache.end(); )
+  {
+    if( it->second.expired() )
+      it = cache.erase(it);
+    else
+      ++it;
+  }
+  return newTable;
+}
+
+template<class T>
+void TeeBeeFilterT<T>::reset()
 {
   feedbackHighpass.reset();
   y1 = 0.0;
@@ -86,3 +177,9 @@ void TeeBeeFilter::reset()
   y3 = 0.0;
   y4 = 0.0;
 }
+
+//-------------------------------------------------------------------------------------------------
+// explicit instantiations:
+
+template class rosic::TeeBeeFilterT<double>;
+template class rosic::TeeBeeFilterT<float>;
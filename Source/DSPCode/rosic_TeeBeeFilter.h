@@ -3,9 +3,12 @@
 
 // standard-library includes:
 #include <stdlib.h>          // for the NULL macro
+#include <string.h>
+#include <memory>
 
 // rosic-indcludes:
 #include "rosic_OnePoleFilter.h"
+#include "rosic_FastMath.h"
 
 namespace rosic
 {
@@ -16,15 +19,19 @@ namespace rosic
   the Moog ladder filter which includes a highpass in the feedback path that reduces the resonance
   on low cutoff frequencies. Moreover, it has a highpass and an allpass filter in the input path to
   pre-shape the input signal (important for the sonic character of internal and subsequent 
-  nonlinearities).
+  nonlinearities). The template parameter is the type of the signal and the filter coefficients 
+  (float or double), the coefficients are calculated in double precision.
 
   ...18 vs. 24 dB? blah?
 
   */
 
-  class TeeBeeFilter
+  template<class T>
+  class TeeBeeFilterT
   {
 
+    template<int numLanes> friend class Open303xN; // processes the TB_303 mode on interleaved states
+
   public:
 
     /** Enumeration of the available filter modes. */
@@ -50,14 +57,24 @@ namespace rosic
       NUM_MODES
     };
 
+    /** Enumeration of the ways to calculate the coefficients when the cutoff or resonance 
+    changes. */
+    enum coefficientModes
+    {
+      APPROXIMATION = 0, // calculateCoefficientsApprox4 (default)
+      LOOKUP_TABLE,      // calculateCoefficientsFromTable
+
+      NUM_COEFFICIENT_MODES
+    };
+
     //---------------------------------------------------------------------------------------------
     // construction/destruction:
 
     /** Constructor. */
-    TeeBeeFilter();
+    TeeBeeFilterT();
 
     /** Destructor. */
-    ~TeeBeeFilter();
+    ~TeeBeeFilterT();
 
     //---------------------------------------------------------------------------------------------
     // parameter settings:
@@ -70,6 +87,12 @@ namespace rosic
     manually later by calling calculateCoefficients. */
     INLINE void setCutoff(double newCutoff, bool updateCoefficients = true);
 
+    /** Sets up a linear ramp from the current filter coefficients towards the coefficients for the
+    new cutoff frequency, such that these are reached after numSteps calls to 
+    incrementCoefficients(). This is cheaper than calling setCutoff per sample when the cutoff is 
+    modulated. */
+    INLINE void setCutoffRamped(double newCutoff, int numSteps);
+
     /** Sets the resonance in percent where 100% is self oscillation. */
     INLINE void setResonance(double newResonance, bool updateCoefficients = true);
 
@@ -82,6 +105,11 @@ namespace rosic
     /** Sets the cutoff frequency for the highpass filter in the feedback path. */
     void setFeedbackHighpassCutoff(double newCutoff) { feedbackHighpass.setCutoff(newCutoff); }
 
+    /** Selects how the coefficients are calculated (@see coefficientModes). Switching to the 
+    LOOKUP_TABLE mode takes the table for the sample rate from a process-wide cache or fills it, 
+    so don't do this on the audio thread. */
+    void setCoefficientMode(int newMode);
+
     //---------------------------------------------------------------------------------------------
     // inquiry:
 
@@ -100,11 +128,23 @@ namespace rosic
     /** Returns the cutoff frequency for the highpass filter in the feedback path. */
     double getFeedbackHighpassCutoff() const { return feedbackHighpass.getCutoff(); }
 
+    /** Returns the way the coefficients are calculated (@see coefficientModes). */
+    int getCoefficientMode() const { return coefficientMode; }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Calculates one output sample at a time. */
-    INLINE double getSample(double in);
+    INLINE T getSample(T in);
+
+    /** Calculates one output sample in the TB_303 mode, which must be the selected one - this 
+    is getSample without the mode branch, for loops that check the mode once per block. */
+    INLINE T getSampleTB303(T in);
+
+    /** The ladder of the TB_303 mode in getSample on coefficients and states that are passed in
+    (the states are updated) - 'feedback' is the output of the feedback highpass for the input 
+    k*shape(y4). This is shared with the lanes of Open303xN. */
+    static INLINE T processLadderTB303(T in, T feedback, T b0, T g, T &y1, T &y2, T &y3, T &y4);
 
     //---------------------------------------------------------------------------------------------
     // others:
@@ -116,8 +156,21 @@ namespace rosic
     for normalized radian cutoff frequencies up to pi/4. */
     INLINE void calculateCoefficientsApprox4();
 
+    /** Causes the filter to re-calculate the coefficients by linear interpolation in a table over 
+    the cutoff, which is filled on sample rate changes. The table has 64 entries per octave, 
+    calculated by the exact formulas for full resonance (lower resonances only scale the feedback 
+    like in calculateCoefficientsApprox4) or the TB_303 formulas. The errors of the interpolation 
+    are printed by open303_bench --table-accuracy. */
+    INLINE void calculateCoefficientsFromTable();
+
+    /** Re-calculates the coefficients in the selected coefficient mode. */
+    INLINE void calculateCoefficients();
+
+    /** Advances the coefficients by one step of the ramp that was set up by setCutoffRamped. */
+    INLINE void incrementCoefficients() { a1 += da1; b0 += db0; k += dk; g += dg; }
+
     /** Implements the waveshaping nonlinearity between the stages. */
-    INLINE double shape(double x);
+    static INLINE T shape(T x);
 
     /** Resets the internal state variables. */
     void reset();
@@ -126,52 +179,108 @@ namespace rosic
 
   protected:
 
-    double b0, a1;              // coefficients for the first order sections
-    double y1, y2, y3, y4;      // output signals of the 4 filter stages 
-    double c0, c1, c2, c3, c4;  // coefficients for combining various ouput stages
-    double k;                   // feedback factor in the loop
-    double g;                   // output gain
-    double driveFactor;         // filter drive as raw factor
+    /** Calculates the coefficients b0 and k (for full resonance) of the TB_303 mode. */
+    static INLINE void calculateTB303Coefficients(double wc, double *b0, double *k);
+
+    /** The table of the LOOKUP_TABLE mode - immutable once filled and shared by all filters with 
+    the same sample rate (@see coefficientTable). */
+    struct CoefficientTable;
+
+    /** Takes the coefficientTable for the passed sample rate from the process-wide cache or fills 
+    a new one, when there is none. Like the mip-maps of the MipMappedWaveTableT, the table is freed
+    when the last filter that uses it switches to another one or is destroyed. */
+    static std::shared_ptr<const CoefficientTable> createCoefficientTable(double sampleRate);
+
+    // the coefficientTable covers the cutoffs from 128 Hz to 32 kHz in 8 octaves with 64 entries 
+    // each - the exponent and the 6 most significant mantissa bits of the cutoff are the index, 
+    // the remaining 46 bits are the position between two entries:
+    static const int    tableFractionBits = 46;
+    static const int    tableSize         = (8 << (52-tableFractionBits)) + 1;
+    static const UINT64 tableMinCutoffBits = 0x4060000000000000ULL; // 128.0
+
+    T      b0, a1;              // coefficients for the first order sections
+    T      y1, y2, y3, y4;      // output signals of the 4 filter stages 
+    T      c0, c1, c2, c3, c4;  // coefficients for combining various ouput stages
+    T      k;                   // feedback factor in the loop
+    T      g;                   // output gain
+    T      da1, db0, dk, dg;    // per step increments of the coefficients for ramped cutoffs
+    T      driveFactor;         // filter drive as raw factor
     double cutoff;              // cutoff frequency
+    double maxCutoff;           // upper limit for the cutoff frequency (depends on the sample rate)
     double drive;               // filter drive in decibels
     double resonanceRaw;        // resonance parameter (normalized to 0...1)
     double resonanceSkewed;     // mapped resonance parameter to make it behave more musical
     double sampleRate;          // the sample rate in Hz
     double twoPiOverSampleRate; // 2*PI/sampleRate
     int    mode;                // the selected filter-mode
+    int    coefficientMode;     // the selected way to calculate the coefficients
+
+    // the shared table of the LOOKUP_TABLE mode (null in the APPROXIMATION mode):
+    std::shared_ptr<const CoefficientTable> coefficientTable;
+
+    OnePoleFilterT<T> feedbackHighpass;
 
-    OnePoleFilter feedbackHighpass;
+  };
 
+  /** Per entry: b0 and the factor for k at full resonance, b0 and k for the TB_303 mode (b0 is 
+  stored instead of a1 because it is nearly proportional to the cutoff, so the interpolation error 
+  relative to b0 is small - a1 is b0-1 by definition). */
+  template<class T>
+  struct TeeBeeFilterT<T>::CoefficientTable
+  {
+    double entries[tableSize][4];
   };
 
   //-----------------------------------------------------------------------------------------------
   // inlined functions:
 
-  INLINE void TeeBeeFilter::setCutoff(double newCutoff, bool updateCoefficients)
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::setCutoff(double newCutoff, bool updateCoefficients)
   {
     if( newCutoff != cutoff )
     {
       if( newCutoff < 200.0 )  // an absolute floor for the cutoff frequency - tweakable
         cutoff = 200.0;  
-      else if( newCutoff > 20000.0 )
-        cutoff = 20000.0;
+      else if( newCutoff > maxCutoff )
+        cutoff = maxCutoff;
       else
         cutoff = newCutoff;
 
       if( updateCoefficients == true )
-        calculateCoefficientsApprox4();
+        calculateCoefficients();
     }
   }
 
-  INLINE void TeeBeeFilter::setResonance(double newResonance, bool updateCoefficients)
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::setCutoffRamped(double newCutoff, int numSteps)
+  {
+    T a1Old = a1, b0Old = b0, kOld = k, gOld = g;
+
+    cutoff = clip(newCutoff, 200.0, maxCutoff);
+    calculateCoefficients();
+
+    T scaler = T(1.0 / numSteps);
+    da1 = scaler * (a1 - a1Old);
+    db0 = scaler * (b0 - b0Old);
+    dk  = scaler * (k  - kOld);
+    dg  = scaler * (g  - gOld);
+    a1  = a1Old;
+    b0  = b0Old;
+    k   = kOld;
+    g   = gOld;
+  }
+
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::setResonance(double newResonance, bool updateCoefficients)
   {
     resonanceRaw    = 0.01 * newResonance;
-    resonanceSkewed = (1.0-exp(-3.0*resonanceRaw)) / (1.0-exp(-3.0));
+    resonanceSkewed = (1.0-fastExp2<MATH_HIGH>(-3.0*ONE_OVER_LN2*resonanceRaw)) / (1.0-exp(-3.0));
     if( updateCoefficients == true )
-      calculateCoefficientsApprox4();
+      calculateCoefficients();
   }
 
-  INLINE void TeeBeeFilter::calculateCoefficientsExact()
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::calculateCoefficientsExact()
   {
     // calculate intermediate variables:
     double wc = twoPiOverSampleRate * cutoff;
@@ -203,7 +312,8 @@ namespace rosic
       k *= (17.0/4.0);
   }
 
-  INLINE void TeeBeeFilter::calculateCoefficientsApprox4()
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::calculateCoefficientsApprox4()
   {
     // calculate intermediate variables:
     double wc  = twoPiOverSampleRate * cutoff;
@@ -255,9 +365,10 @@ namespace rosic
 
     if( mode == TB_303 )
     {
-      double fx = wc * ONE_OVER_SQRT2/(2*PI); 
-      b0 = (0.00045522346 + 6.1922189 * fx) / (1.0 + 12.358354 * fx + 4.4156345 * (fx * fx)); 
-      k  = fx*(fx*(fx*(fx*(fx*(fx+7198.6997)-5837.7917)-476.47308)+614.95611)+213.87126)+16.998792; 
+      double b0303, k303;
+      calculateTB303Coefficients(wc, &b0303, &k303);
+      b0 = b0303;
+      k  = k303;
       g  = k * 0.058823529411764705882352941176471; // 17 reciprocal 
       g  = (g - 1.0) * r + 1.0;                     // r is 0 to 1.0
       g  = (g * (1.0 + r)); 
@@ -265,39 +376,82 @@ namespace rosic
     }
   }
 
-  INLINE double TeeBeeFilter::shape(double x)
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::calculateCoefficientsFromTable()
+  {
+    // find the entries around the cutoff (@see coefficientTable):
+    UINT64 bits;
+    memcpy(&bits, &cutoff, sizeof(bits));
+    int    i  = (int) ((bits - tableMinCutoffBits) >> tableFractionBits);
+    double f  = (double) (bits & ((1ULL << tableFractionBits) - 1)) * (1.0 / (1ULL << tableFractionBits));
+    const double *t0 = coefficientTable->entries[i];
+    const double *t1 = coefficientTable->entries[i+1];
+    double r   = resonanceSkewed;
+
+    b0 = t0[0] + f*(t1[0]-t0[0]);
+    a1 = b0 - 1.0;
+    k  = r * (t0[1] + f*(t1[1]-t0[1]));
+    g  = 1.0;
+
+    if( mode == TB_303 )
+    {
+      b0 = t0[2] + f*(t1[2]-t0[2]);
+      k  = t0[3] + f*(t1[3]-t0[3]);
+      g  = k * 0.058823529411764705882352941176471; // as in calculateCoefficientsApprox4
+      g  = (g - 1.0) * r + 1.0;
+      g  = (g * (1.0 + r)); 
+      k  = k * r;
+    }
+  }
+
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::calculateCoefficients()
+  {
+    if( coefficientMode == LOOKUP_TABLE )
+      calculateCoefficientsFromTable();
+    else
+      calculateCoefficientsApprox4();
+  }
+
+  template<class T>
+  INLINE void TeeBeeFilterT<T>::calculateTB303Coefficients(double wc, double *b0, double *k)
+  {
+    double fx = wc * ONE_OVER_SQRT2/(2*PI); 
+    *b0 = (0.00045522346 + 6.1922189 * fx) / (1.0 + 12.358354 * fx + 4.4156345 * (fx * fx)); 
+    *k  = fx*(fx*(fx*(fx*(fx*(fx+7198.6997)-5837.7917)-476.47308)+614.95611)+213.87126)+16.998792; 
+  }
+
+  template<class T>
+  INLINE T TeeBeeFilterT<T>::shape(T x)
   {
     // return tanhApprox(x); // \todo: find some more suitable nonlinearity here
     //return x; // test
 
-    const double r6 = 1.0/6.0;
-    x = clip(x, -SQRT2, SQRT2);
+    const T r6 = T(1.0/6.0);
+    x = clip(x, T(-SQRT2), T(SQRT2));
     return x - r6*x*x*x;
 
     //return clip(x, -1.0, 1.0);
   }
 
-  INLINE double TeeBeeFilter::getSample(double in)
+  template<class T>
+  INLINE T TeeBeeFilterT<T>::getSampleTB303(T in)
+  {
+    return processLadderTB303(in, feedbackHighpass.getSample(k * shape(y4)), b0, g, 
+                              y1, y2, y3, y4);
+  }
+
+  template<class T>
+  INLINE T TeeBeeFilterT<T>::getSample(T in)
   {
-    double y0;
+    T y0;
 
     if( mode == TB_303 )
-    {
-      y0  = in - feedbackHighpass.getSample(k * shape(y4));  
-      //y0 = in - feedbackHighpass.getSample(k*y4);  
-      //y0  = in - k*shape(y4);  
-      //y0  = in-k*y4;  
-      y1 += 2*b0*(y0-y1+y2);
-      y2 +=   b0*(y1-2*y2+y3);
-      y3 +=   b0*(y2-2*y3+y4);
-      y4 +=   b0*(y3-2*y4);
-      return 2*g*y4;
-      //return 3*y4;
-    }
+      return getSampleTB303(in);
 
     // apply drive and feedback to obtain the filter's input signal:
     //double y0 = inputFilter.getSample(0.125*driveFactor*in) - feedbackHighpass.getSample(k*y4);
-    y0 = 0.125*driveFactor*in - feedbackHighpass.getSample(k*y4);  
+    y0 = T(0.125)*driveFactor*in - feedbackHighpass.getSample(k*y4);  
 
     /*
     // cascade of four 1st order sections with nonlinearities:
@@ -320,9 +474,27 @@ namespace rosic
     y4 = y3 + a1*(y3-y4); // \todo: performance test both versions of the ladder
     //y4 = shape(y3 + a1*(y3-y4)); // \todo: performance test both versions of the ladder
 
-    return 8.0 * (c0*y0 + c1*y1 + c2*y2 + c3*y3 + c4*y4);;
+    return T(8) * (c0*y0 + c1*y1 + c2*y2 + c3*y3 + c4*y4);
   }
 
+  template<class T>
+  INLINE T TeeBeeFilterT<T>::processLadderTB303(T in, T feedback, T b0, T g, 
+                                                T &y1, T &y2, T &y3, T &y4)
+  {
+    T y0 = in - feedback;
+    //y0 = in - feedbackHighpass.getSample(k*y4);  
+    //y0  = in - k*shape(y4);  
+    //y0  = in-k*y4;  
+    y1 += 2*b0*(y0-y1+y2);
+    y2 +=   b0*(y1-2*y2+y3);
+    y3 +=   b0*(y2-2*y3+y4);
+    y4 +=   b0*(y3-2*y4);
+    return 2*g*y4;
+    //return 3*y4;
+  }
+
+  typedef TeeBeeFilterT<double> TeeBeeFilter;
+
 }
 
 #endif // rosic_TeeBeeFilter_h
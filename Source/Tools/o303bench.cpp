@@ -0,0 +1,744 @@
+#include "../DSPCode/rosic_AnalogEnvelope.h"
+#include "../DSPCode/rosic_BlendOscillator.h"
+#include "../DSPCode/rosic_CpuDispatch.h"
+#include "../DSPCode/rosic_EllipticQuarterBandFilter.h"
+#include "../DSPCode/rosic_FastMath.h"
+#include "../DSPCode/rosic_FourierTransformerRadix2.h"
+#include "../DSPCode/rosic_MipMappedWaveTable.h"
+#include "../DSPCode/rosic_Open303.h"
+#include "../DSPCode/rosic_Open303xN.h"
+#include "../DSPCode/rosic_PostFilterChain.h"
+#include "../DSPCode/rosic_TeeBeeFilter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace {
+
+using namespace rosic;
+
+//------------------------------------------------------------------------
+// results are summed into this, so that the compiler can't drop the processing
+volatile double sink = 0.;
+
+//------------------------------------------------------------------------
+/** A benchmark creates the objects under test for a sample rate and returns a function which
+ *	processes the given number of iterations. An iteration is one sample, or one call for the
+ *	benchmarks which aren't per sample.
+ */
+struct Benchmark
+{
+	using Process = std::function<void (int numIterations)>;
+
+	std::string name;
+	std::function<Process (double sampleRate)> setup;
+	bool perSample {true};
+};
+
+//------------------------------------------------------------------------
+struct Options
+{
+	std::vector<double> sampleRates {44100., 48000., 96000.};
+	double minTime {0.1}; // in seconds per repetition
+	int repetitions {5};
+	std::string filter;
+};
+
+//------------------------------------------------------------------------
+// a band limited sawtooth plus a little noise as the input for the filters
+const std::vector<double>& getTestSignal ()
+{
+	static const std::vector<double> signal = [] () {
+		std::vector<double> s (4096);
+		unsigned int state = 1;
+		for (auto i = 0u; i < s.size (); ++i)
+		{
+			double x = 0.;
+			for (auto k = 1; k < 20; ++k)
+				x += std::sin (2. * PI * k * 8. * i / s.size ()) / k;
+			state = 1664525 * state + 1013904223;
+			s[i] = 0.5 * x + 0.01 * (state / 4294967296. - 0.5);
+		}
+		return s;
+	}();
+	return signal;
+}
+
+//------------------------------------------------------------------------
+const char* getFilterModeName (int mode)
+{
+	static const char* names[] = {
+		"FLAT",	 "LP_6",	 "LP_12",	"LP_18",   "LP_24",	  "HP_6",	"HP_12",  "HP_18",
+		"HP_24", "BP_12_12", "BP_6_18", "BP_18_6", "BP_6_12", "BP_12_6", "BP_6_6", "TB_303"};
+	return mode >= 0 && mode < TeeBeeFilter::NUM_MODES ? names[mode] : "?";
+}
+
+//------------------------------------------------------------------------
+const char* getCoefficientModeName (int mode)
+{
+	static const char* names[] = {"APPROXIMATION", "LOOKUP_TABLE"};
+	return mode >= 0 && mode < TeeBeeFilter::NUM_COEFFICIENT_MODES ? names[mode] : "?";
+}
+
+//------------------------------------------------------------------------
+const char* getOscillatorAlgorithmName (int algorithm)
+{
+	static const char* names[] = {"MIP_MAP", "POLY_BLEP"};
+	return algorithm >= 0 && algorithm < BlendOscillator::NUM_ALGORITHMS ? names[algorithm] : "?";
+}
+
+//------------------------------------------------------------------------
+/** Gives access to the coefficients of the filter for the accuracy report. */
+struct CoefficientProbe : TeeBeeFilter
+{
+	struct Coefficients
+	{
+		double a1, b0, k, g;
+	};
+
+	double getMaxCutoff () const { return maxCutoff; }
+	void setFullResonance () { resonanceSkewed = 1.; }
+	Coefficients getCoefficients () const { return {a1, b0, k, g}; }
+};
+
+//------------------------------------------------------------------------
+/** Prints the maximum relative errors of the coefficients of the LOOKUP_TABLE mode and of the
+ *	APPROXIMATION mode against the exact formulas for cutoffs from 200 Hz up to the maximum cutoff
+ *	at full resonance (below, k just scales with the resonance). The exact formulas don't cover the
+ *	TB_303 mode, so its table is compared to the approximation.
+ */
+void printTableAccuracy (const Options& options)
+{
+	auto relativeError = [] (double x, double reference) {
+		return std::abs (x - reference) / std::max (std::abs (reference), 1e-300);
+	};
+
+	std::fprintf (stdout, "%-10s %12s %12s %12s %12s %12s %12s\n", "rate", "table b0",
+				  "table k", "approx b0", "approx k", "303 b0", "303 k");
+	auto probe = std::make_unique<CoefficientProbe> ();
+	for (auto sampleRate : options.sampleRates)
+	{
+		for (auto oversampling : {1, 4})
+		{
+			probe->setSampleRate (oversampling * sampleRate);
+			probe->setCoefficientMode (TeeBeeFilter::LOOKUP_TABLE);
+			probe->setFullResonance ();
+
+			double errors[6] = {};
+			static constexpr int numCutoffs = 100000;
+			auto maxCutoff = probe->getMaxCutoff ();
+			for (auto i = 0; i <= numCutoffs; ++i)
+			{
+				auto cutoff = 200. * std::pow (maxCutoff / 200., double (i) / numCutoffs);
+				probe->setCutoff (cutoff, false);
+				probe->setMode (TeeBeeFilter::LP_24);
+				auto table = probe->getCoefficients ();
+				probe->calculateCoefficientsApprox4 ();
+				auto approx = probe->getCoefficients ();
+				probe->calculateCoefficientsExact ();
+				auto exact = probe->getCoefficients ();
+
+				probe->setMode (TeeBeeFilter::TB_303);
+				auto table303 = probe->getCoefficients ();
+				probe->calculateCoefficientsApprox4 ();
+				auto approx303 = probe->getCoefficients ();
+
+				double e[6] = {relativeError (table.b0, exact.b0),
+							   relativeError (table.k, exact.k),
+							   relativeError (approx.b0, exact.b0),
+							   relativeError (approx.k, exact.k),
+							   relativeError (table303.b0, approx303.b0),
+							   relativeError (table303.k, approx303.k)};
+				for (auto j = 0; j < 6; ++j)
+					errors[j] = std::max (errors[j], e[j]);
+			}
+			auto rate = std::to_string (static_cast<int> (sampleRate)) + "x" +
+						std::to_string (oversampling);
+			std::fprintf (stdout, "%-10s %12.2e %12.2e %12.2e %12.2e %12.2e %12.2e\n",
+						  rate.c_str (), errors[0], errors[1], errors[2], errors[3], errors[4],
+						  errors[5]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+template<typename Object, typename ProcessSample>
+Benchmark::Process makeSampleLoop (std::shared_ptr<Object> object, ProcessSample processSample)
+{
+	return [object, processSample] (int numIterations) {
+		const auto& input = getTestSignal ();
+		double sum = 0.;
+		size_t pos = 0;
+		for (auto i = 0; i < numIterations; ++i)
+		{
+			sum += processSample (*object, input[pos]);
+			if (++pos == input.size ())
+				pos = 0;
+		}
+		sink = sink + sum;
+	};
+}
+
+//------------------------------------------------------------------------
+template<int accuracy>
+void addFastMathBenchmarks (std::vector<Benchmark>& benchmarks, const std::string& tier)
+{
+	struct Stateless
+	{
+	};
+	benchmarks.push_back ({"fastExp2/" + tier, [] (double) {
+							   return makeSampleLoop (
+								   std::make_shared<Stateless> (),
+								   [] (Stateless&, double in) { return fastExp2<accuracy> (8. * in); });
+						   }});
+	benchmarks.push_back ({"fastTanh/" + tier, [] (double) {
+							   return makeSampleLoop (
+								   std::make_shared<Stateless> (),
+								   [] (Stateless&, double in) { return fastTanh<accuracy> (4. * in); });
+						   }});
+	benchmarks.push_back ({"fastSinCos/" + tier, [] (double) {
+							   return makeSampleLoop (std::make_shared<Stateless> (),
+													  [] (Stateless&, double in) {
+														  double s, c;
+														  fastSinCos<accuracy> (4. * in, &s, &c);
+														  return s + c;
+													  });
+						   }});
+}
+
+//------------------------------------------------------------------------
+/** Prints the aliases of the oscillator algorithms at the oversampling factors for a low and a high
+ *	note of the saw and the square. The filter is switched to FLAT and the note is held until the
+ *	envelopes have settled. The note frequencies are multiples of the FFT bin spacing, so the
+ *	analysed block contains whole cycles and the bins that are no multiples of the fundamental's bin
+ *	contain only aliases. Their power up to 20 kHz is printed relative to the power of the
+ *	harmonics, together with the time per sample for the whole synth. The bandwidth is shown by the
+ *	power of the harmonics of the low saw between 10 and 20 kHz relative to all of its harmonics
+ *	(-25 dB for an ideal saw).
+ */
+void printAliasing (const Options& options)
+{
+	static constexpr int fftSize = 1 << 16;
+	static constexpr int fundamentalBins[] = {163, 1307}; // about 110 and 880 Hz at 44.1 kHz
+	static constexpr int blockSize = 64;
+
+	std::fprintf (stdout, "%-10s %-4s %-10s %12s %12s %12s %12s %12s %10s\n", "rate", "os",
+				  "algorithm", "saw low", "saw high", "square low", "square high", "10-20 kHz",
+				  "time");
+	FourierTransformerRadix2 transformer;
+	transformer.setBlockSize (fftSize);
+	std::vector<double> signal (fftSize), spectrum (fftSize);
+	for (auto sampleRate : options.sampleRates)
+	{
+		for (auto oversampling : {1, 2, 4})
+		{
+			for (auto algorithm : {BlendOscillator::MIP_MAP, BlendOscillator::POLY_BLEP})
+			{
+				double aliases[4];
+				double highBand = 0.;
+				double time = 0.;
+				int numSamples = 0;
+				for (auto i = 0; i < 4; ++i)
+				{
+					auto synth = std::make_unique<Open303> ();
+					synth->setAsynchronousWaveformRendering (false);
+					synth->setSampleRate (sampleRate);
+					synth->setOversampling (oversampling);
+					synth->setAntiAliasFilter (Open303::HALFBAND_HIGH);
+					synth->setOscillatorAlgorithm (algorithm);
+					synth->setWaveform (i < 2 ? 0. : 1.);
+					synth->setAmpSustain (0.);
+					synth->setDecay (200.);
+					synth->setResonance (0.);
+					synth->filter.setMode (TeeBeeFilter::FLAT);
+					auto fundamentalBin = fundamentalBins[i % 2];
+					synth->setTuning (fundamentalBin * sampleRate / fftSize);
+					synth->noteOn (69, 64);
+
+					auto start = std::chrono::steady_clock::now ();
+					auto numSettling = static_cast<int> (4. * sampleRate);
+					double block[blockSize];
+					for (auto pos = 0; pos < numSettling; pos += blockSize)
+						synth->processBlock (block, blockSize);
+					for (auto pos = 0; pos < fftSize; pos += blockSize)
+						synth->processBlock (signal.data () + pos, blockSize);
+					std::chrono::duration<double, std::nano> elapsed =
+						std::chrono::steady_clock::now () - start;
+					time += elapsed.count ();
+					numSamples += numSettling + fftSize;
+
+					transformer.transformRealSignal (signal.data (), spectrum.data ());
+					double harmonicPower = 0., aliasPower = 0., highBandPower = 0.;
+					auto maxBin = static_cast<int> (20000. * fftSize / sampleRate);
+					for (auto bin = 1; bin <= maxBin; ++bin)
+					{
+						auto power = spectrum[2 * bin] * spectrum[2 * bin] +
+									 spectrum[2 * bin + 1] * spectrum[2 * bin + 1];
+						(bin % fundamentalBin == 0 ? harmonicPower : aliasPower) += power;
+						if (bin % fundamentalBin == 0 && bin * sampleRate / fftSize >= 10000.)
+							highBandPower += power;
+					}
+					aliases[i] = 10. * std::log10 (std::max (aliasPower, 1e-300) / harmonicPower);
+					if (i == 0)
+						highBand = 10. * std::log10 (std::max (highBandPower, 1e-300) / harmonicPower);
+				}
+				std::fprintf (stdout,
+							  "%-10.0f %-4d %-10s %9.1f dB %9.1f dB %9.1f dB %9.1f dB %9.1f dB %5.0f ns/S\n",
+							  sampleRate, oversampling, getOscillatorAlgorithmName (algorithm),
+							  aliases[0], aliases[1], aliases[2], aliases[3], highBand,
+							  time / numSamples);
+				std::fflush (stdout);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+void setupPattern (Open303& synth)
+{
+	auto& sequencer = synth.sequencer;
+	sequencer.setActivePattern (0);
+	for (auto step = 0; step < 16; ++step)
+	{
+		sequencer.setKey (0, step, (step * 5) % 12);
+		sequencer.setOctave (0, step, step % 3 - 1);
+		sequencer.setAccent (0, step, step % 4 == 0);
+		sequencer.setSlide (0, step, step % 6 == 5);
+		sequencer.setGate (0, step, step % 8 != 7);
+	}
+	sequencer.setMode (AcidSequencer::KEY_SYNC);
+}
+
+//------------------------------------------------------------------------
+template <int numLanes>
+void addLanesBenchmark (std::vector<Benchmark>& benchmarks)
+{
+	benchmarks.push_back (
+		{"Open303x" + std::to_string (numLanes) + "::processBlock",
+		 [] (double sampleRate) -> Benchmark::Process {
+			 static constexpr int blockSize = 64;
+			 auto synths = std::make_shared<Open303xN<numLanes>> ();
+			 synths->setSampleRate (sampleRate);
+			 for (auto v = 0; v < numLanes; ++v)
+			 {
+				 auto& synth = synths->voices[v];
+				 synth.setAsynchronousWaveformRendering (false);
+				 synth.setCutoff (400. + 100. * v);
+				 synth.setResonance (80.);
+				 synth.setEnvMod (60.);
+				 synth.setDecay (800.);
+				 synth.setAmpSustain (-6.);
+				 synth.noteOn (36 + v, 100);
+			 }
+			 return [synths] (int numIterations) {
+				 double blocks[numLanes][blockSize];
+				 double* out[numLanes];
+				 for (auto v = 0; v < numLanes; ++v)
+					 out[v] = blocks[v];
+				 double sum = 0.;
+				 auto numFrames = std::max (1, numIterations / numLanes);
+				 for (auto pos = 0; pos < numFrames; pos += blockSize)
+				 {
+					 auto n = std::min (blockSize, numFrames - pos);
+					 synths->processBlock (out, n);
+					 sum += blocks[0][n - 1];
+				 }
+				 sink = sink + sum;
+			 };
+		 }});
+}
+
+//------------------------------------------------------------------------
+std::vector<Benchmark> createBenchmarks ()
+{
+	std::vector<Benchmark> benchmarks;
+
+	for (auto mode = 0; mode < TeeBeeFilter::NUM_MODES; ++mode)
+	{
+		benchmarks.push_back (
+			{std::string ("TeeBeeFilter::getSample/") + getFilterModeName (mode),
+			 [mode] (double sampleRate) {
+				 auto filter = std::make_shared<TeeBeeFilter> ();
+				 filter->setSampleRate (sampleRate);
+				 filter->setMode (mode);
+				 filter->setCutoff (800.);
+				 filter->setResonance (70.);
+				 return makeSampleLoop (filter,
+										[] (TeeBeeFilter& f, double in) { return f.getSample (in); });
+			 }});
+	}
+
+	// the same without the mode branch, as in Open303::renderBlock
+	benchmarks.push_back ({"TeeBeeFilter::getSampleTB303", [] (double sampleRate) {
+							   auto filter = std::make_shared<TeeBeeFilter> ();
+							   filter->setSampleRate (sampleRate);
+							   filter->setMode (TeeBeeFilter::TB_303);
+							   filter->setCutoff (800.);
+							   filter->setResonance (70.);
+							   return makeSampleLoop (filter, [] (TeeBeeFilter& f, double in) {
+								   return f.getSampleTB303 (in);
+							   });
+						   }});
+
+	// the cutoff modulated on every sample, like by the envelope in Open303
+	for (auto coefficientMode : {TeeBeeFilter::APPROXIMATION, TeeBeeFilter::LOOKUP_TABLE})
+	{
+		benchmarks.push_back (
+			{std::string ("TeeBeeFilter::setCutoff/") + getCoefficientModeName (coefficientMode),
+			 [coefficientMode] (double sampleRate) {
+				 auto filter = std::make_shared<TeeBeeFilter> ();
+				 filter->setSampleRate (sampleRate);
+				 filter->setCoefficientMode (coefficientMode);
+				 filter->setResonance (70.);
+				 return makeSampleLoop (filter, [] (TeeBeeFilter& f, double in) {
+					 f.setCutoff (2000. + 1500. * in);
+					 return f.getSample (in);
+				 });
+			 }});
+	}
+
+	for (auto algorithm : {BlendOscillator::MIP_MAP, BlendOscillator::POLY_BLEP})
+	{
+		benchmarks.push_back (
+			{std::string ("BlendOscillator::getSample/") + getOscillatorAlgorithmName (algorithm),
+			 [algorithm] (double sampleRate) {
+				 struct Objects
+				 {
+					 MipMappedWaveTable saw, square;
+					 BlendOscillator oscillator;
+				 };
+				 auto objects = std::make_shared<Objects> ();
+				 objects->saw.setWaveform (MipMappedWaveTable::SAW303);
+				 objects->square.setWaveform (MipMappedWaveTable::SQUARE303);
+				 objects->oscillator.setWaveTable1 (&objects->saw);
+				 objects->oscillator.setWaveTable2 (&objects->square);
+				 objects->oscillator.setAlgorithm (algorithm);
+				 objects->oscillator.setSampleRate (sampleRate);
+				 objects->oscillator.setBlendFactor (0.5);
+				 objects->oscillator.setFrequency (110.);
+				 return makeSampleLoop (
+					 objects, [] (Objects& o, double) { return o.oscillator.getSample (); });
+			 }});
+	}
+
+	benchmarks.push_back (
+		{"EllipticQuarterBandFilter::getSample", [] (double) {
+			 return makeSampleLoop (
+				 std::make_shared<EllipticQuarterBandFilter> (),
+				 [] (EllipticQuarterBandFilter& f, double in) { return f.getSample (in); });
+		 }});
+
+	auto createPostFilterChain = [] (double sampleRate) {
+		auto chain = std::make_shared<PostFilterChain> ();
+		chain->setSampleRate (sampleRate);
+		chain->setHighpassCutoff (24.167);
+		chain->setAllpassCutoff (14.008);
+		chain->setNotchFrequency (7.5164);
+		chain->setNotchBandwidth (4.7);
+		return chain;
+	};
+	benchmarks.push_back (
+		{"PostFilterChain::getSample", [createPostFilterChain] (double sampleRate) {
+			 return makeSampleLoop (createPostFilterChain (sampleRate),
+									[] (PostFilterChain& c, double in) { return c.getSample (in); });
+		 }});
+	benchmarks.push_back (
+		{"PostFilterChain::processBlock",
+		 [createPostFilterChain] (double sampleRate) -> Benchmark::Process {
+			 static constexpr int blockSize = 64;
+			 auto chain = createPostFilterChain (sampleRate);
+			 return [chain] (int numIterations) {
+				 const auto& input = getTestSignal ();
+				 double buffer[blockSize], amp[blockSize], out[blockSize];
+				 std::fill (amp, amp + blockSize, 0.5);
+				 double sum = 0.;
+				 size_t start = 0;
+				 for (auto pos = 0; pos < numIterations; pos += blockSize)
+				 {
+					 auto n = std::min (blockSize, numIterations - pos);
+					 if (start + n > input.size ())
+						 start = 0;
+					 std::copy (input.begin () + start, input.begin () + start + n, buffer);
+					 chain->processBlock (buffer, amp, nullptr, 0.7, out, n);
+					 sum += out[n - 1];
+					 start += n;
+				 }
+				 sink = sink + sum;
+			 };
+		 }});
+
+	benchmarks.push_back (
+		{"AnalogEnvelope::getSample", [] (double sampleRate) {
+			 auto envelope = std::make_shared<AnalogEnvelope> ();
+			 envelope->setSampleRate (sampleRate);
+			 envelope->setAttack (0.);
+			 envelope->setDecay (1230.);
+			 envelope->setSustainLevel (0.5);
+			 envelope->setRelease (0.5);
+			 envelope->noteOn ();
+			 return makeSampleLoop (envelope,
+									[] (AnalogEnvelope& e, double) { return e.getSample (); });
+		 }});
+
+	addFastMathBenchmarks<MATH_EXACT> (benchmarks, "EXACT");
+	addFastMathBenchmarks<MATH_HIGH> (benchmarks, "HIGH");
+	addFastMathBenchmarks<MATH_FAST> (benchmarks, "FAST");
+
+	benchmarks.push_back ({"MipMappedWaveTable::generateMipMap",
+						   [] (double) -> Benchmark::Process {
+							   // custom waveforms are not cached, so every call renders all tables
+							   auto table = std::make_shared<MipMappedWaveTable> ();
+							   auto prototype =
+								   std::make_shared<std::vector<double>> (getTestSignal ());
+							   prototype->resize (2048); // the table length of MipMappedWaveTable
+							   return [table, prototype] (int numIterations) {
+								   for (auto i = 0; i < numIterations; ++i)
+									   table->setWaveform (prototype->data (),
+														   static_cast<int> (prototype->size ()));
+								   sink = sink + table->getValueLinear (0.5, 0);
+							   };
+						   },
+						   false});
+
+	for (auto useSequencer : {false, true})
+	{
+		auto createSynth = [useSequencer] (double sampleRate) {
+			auto synth = std::make_shared<Open303> ();
+			synth->setAsynchronousWaveformRendering (false);
+			synth->setSampleRate (sampleRate);
+			synth->setCutoff (600.);
+			synth->setResonance (80.);
+			synth->setEnvMod (60.);
+			synth->setDecay (800.);
+			synth->setAccent (70.);
+			synth->setAmpSustain (-6.);
+			if (useSequencer)
+				setupPattern (*synth);
+			synth->noteOn (41, 100);
+			return synth;
+		};
+		std::string mode = useSequencer ? "sequencer" : "note";
+		benchmarks.push_back (
+			{"Open303::getSample/" + mode, [createSynth] (double sampleRate) {
+				 return makeSampleLoop (createSynth (sampleRate),
+										[] (Open303& s, double) { return s.getSample (); });
+			 }});
+		benchmarks.push_back (
+			{"Open303::processBlock/" + mode,
+			 [createSynth] (double sampleRate) -> Benchmark::Process {
+				 static constexpr int blockSize = 64;
+				 auto synth = createSynth (sampleRate);
+				 return [synth] (int numIterations) {
+					 double block[blockSize];
+					 double sum = 0.;
+					 for (auto pos = 0; pos < numIterations; pos += blockSize)
+					 {
+						 auto n = std::min (blockSize, numIterations - pos);
+						 synth->processBlock (block, n);
+						 sum += block[n - 1];
+					 }
+					 sink = sink + sum;
+				 };
+			 }});
+	}
+
+	// a host that automates the cutoff and the envmod on every block, so they ramp all the time
+	benchmarks.push_back (
+		{"Open303::processBlock/automation", [] (double sampleRate) -> Benchmark::Process {
+			 static constexpr int blockSize = 64;
+			 auto synth = std::make_shared<Open303> ();
+			 synth->setAsynchronousWaveformRendering (false);
+			 synth->setSampleRate (sampleRate);
+			 synth->setSmoothingTime (5.);
+			 synth->setResonance (80.);
+			 synth->setAmpSustain (-6.);
+			 synth->noteOn (41, 100);
+			 return [synth] (int numIterations) {
+				 double block[blockSize];
+				 double sum = 0.;
+				 for (auto pos = 0; pos < numIterations; pos += blockSize)
+				 {
+					 auto phase = (pos / blockSize) % 256 / 256.;
+					 synth->setParameterSmoothly (Open303::CUTOFF, 400. + 1600. * phase);
+					 synth->setParameterSmoothly (Open303::ENVMOD, 100. * phase);
+					 auto n = std::min (blockSize, numIterations - pos);
+					 synth->processBlock (block, n);
+					 sum += block[n - 1];
+				 }
+				 sink = sink + sum;
+			 };
+		 }});
+
+	// several instances in lockstep, the time is per sample of one instance
+	addLanesBenchmark<4> (benchmarks);
+	addLanesBenchmark<8> (benchmarks);
+	return benchmarks;
+}
+
+//------------------------------------------------------------------------
+// returns the time per iteration in nanoseconds (the median of the repetitions)
+double runBenchmark (const Benchmark& benchmark, double sampleRate, const Options& options)
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto process = benchmark.setup (sampleRate);
+
+	// find the number of iterations which take at least minTime (also warms up caches)
+	int numIterations = benchmark.perSample ? 1024 : 1;
+	for (;;)
+	{
+		auto start = Clock::now ();
+		process (numIterations);
+		std::chrono::duration<double> elapsed = Clock::now () - start;
+		if (elapsed.count () >= options.minTime || numIterations >= (1 << 30))
+			break;
+		auto factor = options.minTime / std::max (elapsed.count (), 1e-9);
+		numIterations = static_cast<int> (
+			std::min (numIterations * std::clamp (factor * 1.2, 2., 100.), double (1 << 30)));
+	}
+
+	std::vector<double> times;
+	for (auto i = 0; i < options.repetitions; ++i)
+	{
+		auto start = Clock::now ();
+		process (numIterations);
+		std::chrono::duration<double, std::nano> elapsed = Clock::now () - start;
+		times.push_back (elapsed.count () / numIterations);
+	}
+	std::nth_element (times.begin (), times.begin () + times.size () / 2, times.end ());
+	return times[times.size () / 2];
+}
+
+//------------------------------------------------------------------------
+void printUsage ()
+{
+	std::fprintf (stderr, "usage: open303_bench [options] [filter]\n"
+						  "\n"
+						  "Runs the benchmarks whose names contain the filter string.\n"
+						  "\n"
+						  "options:\n"
+						  "  -r, --samplerate <Hz>   run at this sample rate only (can be repeated,\n"
+						  "                          default 44100, 48000 and 96000)\n"
+						  "      --min-time <s>      minimum time per repetition (0.1)\n"
+						  "      --repetitions <n>   repetitions, the median is reported (5)\n"
+						  "      --table-accuracy    print the errors of the filter coefficients of\n"
+						  "                          TeeBeeFilter::LOOKUP_TABLE instead\n"
+						  "      --aliasing          print the aliases of the oscillator algorithms\n"
+						  "                          at 1x, 2x and 4x oversampling instead\n"
+						  "      --isa <name>        run the kernels for this instruction set\n"
+						  "                          (baseline, avx2 or avx512, default: the best\n"
+						  "                          one the CPU supports)\n"
+						  "  -l, --list              list the benchmarks\n");
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	Options options;
+	auto benchmarks = createBenchmarks ();
+	bool sampleRatesGiven = false;
+	bool tableAccuracy = false;
+	bool aliasing = false;
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		auto hasValue = i + 1 < argc;
+		if ((arg == "-r" || arg == "--samplerate") && hasValue)
+		{
+			if (!sampleRatesGiven)
+				options.sampleRates.clear ();
+			sampleRatesGiven = true;
+			options.sampleRates.push_back (std::atof (argv[++i]));
+		}
+		else if (arg == "--min-time" && hasValue)
+			options.minTime = std::atof (argv[++i]);
+		else if (arg == "--repetitions" && hasValue)
+			options.repetitions = std::max (1, std::atoi (argv[++i]));
+		else if (arg == "--table-accuracy")
+			tableAccuracy = true;
+		else if (arg == "--aliasing")
+			aliasing = true;
+		else if (arg == "--isa" && hasValue)
+		{
+			auto instructionSet = CpuDispatch::findInstructionSet (argv[++i]);
+			if (instructionSet < 0)
+			{
+				std::fprintf (stderr, "unknown instruction set %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+			CpuDispatch::setInstructionSet (instructionSet);
+		}
+		else if (arg == "-l" || arg == "--list")
+		{
+			for (const auto& benchmark : benchmarks)
+				std::fprintf (stdout, "%s\n", benchmark.name.c_str ());
+			return EXIT_SUCCESS;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage ();
+			return EXIT_SUCCESS;
+		}
+		else if (!arg.empty () && arg[0] != '-' && options.filter.empty ())
+			options.filter = arg;
+		else
+		{
+			printUsage ();
+			return EXIT_FAILURE;
+		}
+	}
+	if (std::any_of (options.sampleRates.begin (), options.sampleRates.end (),
+					 [] (double sampleRate) { return sampleRate <= 0.; }))
+	{
+		std::fprintf (stderr, "invalid sample rate\n");
+		return EXIT_FAILURE;
+	}
+
+	if (tableAccuracy)
+	{
+		printTableAccuracy (options);
+		return EXIT_SUCCESS;
+	}
+	if (aliasing)
+	{
+		printAliasing (options);
+		return EXIT_SUCCESS;
+	}
+
+#ifndef NDEBUG
+	std::fprintf (stderr, "warning: this is not a release build, the numbers are meaningless\n\n");
+#endif
+
+	std::fprintf (stdout, "instruction set: %s (detected: %s)\n\n",
+				  CpuDispatch::getInstructionSetName (CpuDispatch::getInstructionSet ()),
+				  CpuDispatch::getInstructionSetName (CpuDispatch::getDetectedInstructionSet ()));
+	std::fprintf (stdout, "%-42s %10s %14s %14s\n", "benchmark", "rate", "time", "x realtime");
+	for (const auto& benchmark : benchmarks)
+	{
+		if (benchmark.name.find (options.filter) == std::string::npos)
+			continue;
+		for (auto sampleRate : options.sampleRates)
+		{
+			auto ns = runBenchmark (benchmark, sampleRate, options);
+			if (benchmark.perSample)
+				std::fprintf (stdout, "%-42s %10.0f %9.2f ns/S %13.0fx\n", benchmark.name.c_str (),
+							  sampleRate, ns, 1e9 / (ns * sampleRate));
+			else
+				std::fprintf (stdout, "%-42s %10.0f %9.1f us   %14s\n", benchmark.name.c_str (),
+							  sampleRate, ns * 1e-3, "-");
+			std::fflush (stdout);
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,475 @@
+#include "o303headless.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <type_traits>
+
+//------------------------------------------------------------------------
+namespace o303 {
+namespace {
+
+//------------------------------------------------------------------------
+// the value of the multi-character literal with these characters (like 'o303' in the plug-in),
+// without the warnings of multi-character literals
+constexpr int32_t fourCC (const char (&id)[5])
+{
+	return static_cast<int32_t> (
+		(static_cast<uint32_t> (id[0]) << 24) | (static_cast<uint32_t> (id[1]) << 16) |
+		(static_cast<uint32_t> (id[2]) << 8) | static_cast<uint32_t> (id[3]));
+}
+
+//------------------------------------------------------------------------
+// the binary format of the plug-in's state, see o303controller.cpp
+static constexpr int32_t stateID = fourCC ("o303");
+static constexpr int32_t stateVersion = 1;
+static constexpr int32_t patStateID = fourCC ("patt");
+static constexpr int32_t patStateVersion = 2;
+
+//------------------------------------------------------------------------
+// the parameter indices of the state (ParameterID in o303pids.h), the extended parameters are
+// only present in states of builds with O303_EXTENDED_PARAMETERS
+enum Parameter
+{
+	Waveform,
+	Tuning,
+	Cutoff,
+	Resonance,
+	Envmod,
+	Decay,
+	Accent,
+	Volume,
+	Filter_Type,
+	AudioPeak,
+	PitchBend,
+	DecayMode,
+	SeqMode,
+	SeqChordFollow,
+	SeqPlayingStep,
+	SeqActivePattern,
+
+	NumStandardParameters,
+
+	Amp_Sustain = NumStandardParameters,
+	Tanh_Shaper_Drive,
+	Tanh_Shaper_Offset,
+	Pre_Filter_Hpf,
+	Feedback_Hpf,
+	Post_Filter_Hpf,
+	Square_Phase_Shift,
+
+	NumExtendedParameters,
+};
+
+//------------------------------------------------------------------------
+// the normalized to plain conversions of vst3utils
+inline double linear (double min, double max, double normalized)
+{
+	return normalized * (max - min) + min;
+}
+
+inline double exponent (double min, double max, double normalized)
+{
+	return min * std::exp (normalized * std::log (max / min));
+}
+
+inline int steps (int numSteps, int startValue, double normalized)
+{
+	return std::min (numSteps, static_cast<int> (normalized * (numSteps + 1))) + startValue;
+}
+
+//------------------------------------------------------------------------
+struct Reader
+{
+	const uint8_t* pos;
+	const uint8_t* end;
+
+	template<typename T>
+	bool read (T& value)
+	{
+		if (end - pos < static_cast<ptrdiff_t> (sizeof (T)))
+			return false;
+		uint64_t bits = 0;
+		for (auto i = 0u; i < sizeof (T); ++i)
+			bits |= static_cast<uint64_t> (pos[i]) << (8 * i);
+		pos += sizeof (T);
+		if constexpr (std::is_same_v<T, double>)
+			std::memcpy (&value, &bits, sizeof (T));
+		else
+			value = static_cast<T> (bits);
+		return true;
+	}
+
+	bool read (bool& value)
+	{
+		uint8_t v;
+		if (!read (v))
+			return false;
+		value = v != 0;
+		return true;
+	}
+};
+
+//------------------------------------------------------------------------
+std::optional<std::vector<double>> loadParameters (Reader& s)
+{
+	int32_t id, version;
+	uint32_t numParameters;
+	if (!s.read (id) || id != stateID)
+		return {};
+	if (!s.read (version) || version > stateVersion)
+		return {};
+	if (!s.read (numParameters) || numParameters == 0)
+		return {};
+	std::vector<double> result (numParameters);
+	for (auto& p : result)
+	{
+		if (!s.read (p))
+			return {};
+	}
+	return {result};
+}
+
+//------------------------------------------------------------------------
+bool loadAcidPattern (rosic::AcidPattern& pattern, Reader& s)
+{
+	int32_t id, version;
+	if (!s.read (id) || id != patStateID)
+		return false;
+	if (!s.read (version) || version > patStateVersion)
+		return false;
+
+	double dv {};
+	if (!s.read (dv))
+		return false;
+	pattern.setStepLength (dv);
+	if (version > 1)
+	{
+		if (!s.read (dv))
+			return false;
+		pattern.setTempoMul (dv);
+	}
+	int32_t numSteps {};
+	if (!s.read (numSteps) || numSteps != pattern.getMaxNumSteps ())
+		return false;
+	if (!s.read (numSteps))
+		return false;
+	pattern.setNumSteps (numSteps);
+	for (auto step = 0; step < pattern.getMaxNumSteps (); ++step)
+	{
+		int32_t key, octave;
+		bool accent, slide, gate;
+		if (!s.read (key) || !s.read (octave) || !s.read (accent) || !s.read (slide) ||
+			!s.read (gate))
+			return false;
+		pattern.setKey (step, key);
+		pattern.setOctave (step, octave);
+		pattern.setAccent (step, accent);
+		pattern.setSlide (step, slide);
+		pattern.setGate (step, gate);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+void applyParameters (const std::vector<double>& parameter, rosic::Open303& synth)
+{
+	// states of older versions lack the parameters at the end, these keep the synth's defaults
+	bool extended = parameter.size () >= NumExtendedParameters;
+	auto has = [&] (size_t index) { return index < parameter.size (); };
+
+	if (has (Waveform))
+		synth.setWaveform (linear (0., 1., parameter[Waveform]));
+	if (has (Tuning))
+		synth.setTuning (linear (400., 480., parameter[Tuning]));
+	if (has (Cutoff))
+		synth.setCutoff (exponent (314., 2394., parameter[Cutoff]));
+	if (has (Resonance))
+		synth.setResonance (linear (0., 100., parameter[Resonance]));
+	if (has (Envmod))
+		synth.setEnvMod (linear (0., 100., parameter[Envmod]));
+	if (has (Decay))
+	{
+		bool alt = has (DecayMode) && parameter[DecayMode] >= 0.5;
+		synth.setDecay (alt ? exponent (30., 3000., parameter[Decay])
+							: exponent (200., 2000., parameter[Decay]));
+	}
+	if (has (Accent))
+		synth.setAccent (linear (0., 100., parameter[Accent]));
+	if (has (Volume))
+		synth.setVolume (linear (-60., 0., parameter[Volume]));
+	if (has (Filter_Type))
+		synth.filter.setMode (steps (15, 0, parameter[Filter_Type]));
+	if (has (PitchBend))
+		synth.setPitchBend (linear (-12., 12., parameter[PitchBend]));
+	if (has (SeqActivePattern))
+		synth.sequencer.setActivePattern (steps (15, 1, parameter[SeqActivePattern]) - 1);
+
+	size_t oversamplingIndex = NumStandardParameters;
+	if (extended)
+	{
+		synth.setAmpSustain (linear (-60., 0., parameter[Amp_Sustain]));
+		synth.setTanhShaperDrive (linear (0., 60., parameter[Tanh_Shaper_Drive]));
+		synth.setTanhShaperOffset (linear (-10., 10., parameter[Tanh_Shaper_Offset]));
+		synth.setPreFilterHighpass (exponent (10., 500., parameter[Pre_Filter_Hpf]));
+		synth.setFeedbackHighpass (exponent (10., 500., parameter[Feedback_Hpf]));
+		synth.setPostFilterHighpass (exponent (10., 500., parameter[Post_Filter_Hpf]));
+		synth.setSquarePhaseShift (linear (0., 360., parameter[Square_Phase_Shift]));
+		oversamplingIndex = NumExtendedParameters;
+	}
+	if (has (oversamplingIndex))
+		synth.setOversampling (1 << steps (3, 0, parameter[oversamplingIndex]));
+	if (has (oversamplingIndex + 1))
+		synth.setOscillatorAlgorithm (steps (1, 0, parameter[oversamplingIndex + 1]));
+}
+
+//------------------------------------------------------------------------
+// returns the component state chunk of a .vstpreset file
+std::optional<std::vector<uint8_t>> getComponentState (const std::vector<uint8_t>& data)
+{
+	static constexpr auto classIDSize = 32;
+	if (data.size () < 8 + classIDSize + 8)
+		return {};
+	Reader s {data.data (), data.data () + data.size ()};
+	s.pos += 8 + classIDSize; // 'VST3', version, class ID
+	int64_t listOffset;
+	if (!s.read (listOffset) || listOffset < 0 ||
+		listOffset > static_cast<int64_t> (data.size ()) - 8)
+		return {};
+	s.pos = data.data () + listOffset;
+	if (std::memcmp (s.pos, "List", 4) != 0)
+		return {};
+	s.pos += 4;
+	int32_t numEntries;
+	if (!s.read (numEntries))
+		return {};
+	for (auto i = 0; i < numEntries; ++i)
+	{
+		if (s.end - s.pos < 4)
+			return {};
+		bool isComponentState = std::memcmp (s.pos, "Comp", 4) == 0;
+		s.pos += 4;
+		int64_t offset, size;
+		if (!s.read (offset) || !s.read (size))
+			return {};
+		if (!isComponentState)
+			continue;
+		if (offset < 0 || size < 0 || offset + size > static_cast<int64_t> (data.size ()))
+			return {};
+		return {std::vector<uint8_t> (data.begin () + offset, data.begin () + offset + size)};
+	}
+	return {};
+}
+
+//------------------------------------------------------------------------
+template<typename T>
+void append (std::vector<uint8_t>& bytes, T value, size_t numBytes = sizeof (T))
+{
+	uint64_t bits = 0;
+	if constexpr (std::is_floating_point_v<T>)
+		std::memcpy (&bits, &value, sizeof (T));
+	else
+		bits = static_cast<uint64_t> (value);
+	for (auto i = 0u; i < numBytes; ++i)
+		bytes.push_back (static_cast<uint8_t> (bits >> (8 * i)));
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+bool loadProcessorState (const std::vector<uint8_t>& data, rosic::Open303& synth,
+						 std::string& error)
+{
+	if (data.size () >= 4 && std::memcmp (data.data (), "VST3", 4) == 0)
+	{
+		auto state = getComponentState (data);
+		if (!state)
+		{
+			error = "no component state in preset";
+			return false;
+		}
+		return loadProcessorState (*state, synth, error);
+	}
+
+	Reader s {data.data (), data.data () + data.size ()};
+	auto parameter = loadParameters (s);
+	if (!parameter)
+	{
+		error = "invalid parameter state";
+		return false;
+	}
+	for (auto index = 0; index < synth.sequencer.getNumPatterns (); ++index)
+	{
+		if (!loadAcidPattern (*synth.sequencer.getPattern (index), s))
+		{
+			error = "invalid pattern " + std::to_string (index + 1);
+			return false;
+		}
+	}
+	applyParameters (*parameter, synth);
+	return true;
+}
+
+//------------------------------------------------------------------------
+int64_t getRenderLength (const RenderSettings& settings)
+{
+	double seconds = settings.bars * 4. * 60. / settings.tempo + settings.tailSeconds;
+	return static_cast<int64_t> (std::round (seconds * settings.sampleRate));
+}
+
+//------------------------------------------------------------------------
+void render (rosic::Open303& synth, const RenderSettings& settings, std::vector<double>& output)
+{
+	static constexpr int blockSize = 4096;
+
+	synth.setSampleRate (settings.sampleRate);
+	synth.sequencer.setTempo (settings.tempo);
+	synth.sequencer.setMode (rosic::AcidSequencer::KEY_SYNC);
+	if (settings.pattern >= 0)
+		synth.sequencer.setActivePattern (settings.pattern);
+
+	auto numFrames = getRenderLength (settings);
+	auto noteOffFrame = static_cast<int64_t> (
+		std::round (settings.bars * 4. * 60. / settings.tempo * settings.sampleRate));
+	output.resize (numFrames);
+
+	synth.noteOn (settings.rootNote, settings.velocity);
+	for (int64_t pos = 0; pos < numFrames;)
+	{
+		if (pos == noteOffFrame)
+			synth.noteOn (settings.rootNote, 0);
+		auto end = pos < noteOffFrame ? std::min (numFrames, noteOffFrame) : numFrames;
+		auto n = static_cast<int> (std::min<int64_t> (blockSize, end - pos));
+		synth.processBlock (output.data () + pos, n);
+		pos += n;
+	}
+}
+
+//------------------------------------------------------------------------
+std::optional<std::vector<RenderJob>> parseManifest (const std::string& path,
+													 const RenderSettings& defaults,
+													 std::string& error)
+{
+	std::ifstream file (path);
+	if (!file)
+	{
+		error = "can't read manifest";
+		return {};
+	}
+	auto baseDir = std::filesystem::path (path).parent_path ();
+	auto resolve = [&] (const std::string& p) { return (baseDir / p).lexically_normal ().string (); };
+
+	std::vector<RenderJob> jobs;
+	std::string line;
+	for (auto lineNumber = 1; std::getline (file, line); ++lineNumber)
+	{
+		std::istringstream fields (line);
+		std::string statePath;
+		if (!(fields >> statePath) || statePath[0] == '#')
+			continue;
+		RenderJob job {"", "", defaults};
+		int pattern;
+		std::string outputPath, rest;
+		if (!(fields >> pattern >> job.settings.tempo >> job.settings.bars >> outputPath) ||
+			(fields >> rest) || pattern < 0 || pattern > 16 || job.settings.tempo <= 0. ||
+			job.settings.bars < 0.)
+		{
+			error = "invalid job in line " + std::to_string (lineNumber);
+			return {};
+		}
+		job.settings.pattern = pattern - 1;
+		job.statePath = resolve (statePath);
+		job.outputPath = resolve (outputPath);
+		jobs.push_back (std::move (job));
+	}
+	return {std::move (jobs)};
+}
+
+//------------------------------------------------------------------------
+std::optional<SampleFormat> parseSampleFormat (const std::string& name)
+{
+	if (name == "wav16")
+		return SampleFormat::Wav16;
+	if (name == "wav24")
+		return SampleFormat::Wav24;
+	if (name == "wav32f")
+		return SampleFormat::Wav32Float;
+	if (name == "raw32f")
+		return SampleFormat::Raw32Float;
+	if (name == "raw64f")
+		return SampleFormat::Raw64Float;
+	return {};
+}
+
+//------------------------------------------------------------------------
+bool writeAudioFile (const std::string& path, const std::vector<double>& signal,
+					 double sampleRate, SampleFormat format)
+{
+	int bitsPerSample = 32;
+	switch (format)
+	{
+		case SampleFormat::Wav16: bitsPerSample = 16; break;
+		case SampleFormat::Wav24: bitsPerSample = 24; break;
+		case SampleFormat::Raw64Float: bitsPerSample = 64; break;
+		default: break;
+	}
+	auto bytesPerSample = bitsPerSample / 8;
+	bool isFloat = format == SampleFormat::Wav32Float || format == SampleFormat::Raw32Float ||
+				   format == SampleFormat::Raw64Float;
+	bool isWav = format == SampleFormat::Wav16 || format == SampleFormat::Wav24 ||
+				 format == SampleFormat::Wav32Float;
+
+	std::vector<uint8_t> bytes;
+	bytes.reserve (44 + signal.size () * bytesPerSample);
+	if (isWav)
+	{
+		auto dataSize = static_cast<uint32_t> (signal.size () * bytesPerSample);
+		auto rate = static_cast<uint32_t> (std::round (sampleRate));
+		bytes.insert (bytes.end (), {'R', 'I', 'F', 'F'});
+		append<uint32_t> (bytes, 36 + dataSize);
+		bytes.insert (bytes.end (), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+		append<uint32_t> (bytes, 16);
+		append<uint16_t> (bytes, isFloat ? 3 : 1); // IEEE float or PCM
+		append<uint16_t> (bytes, 1);			   // mono
+		append<uint32_t> (bytes, rate);
+		append<uint32_t> (bytes, rate * bytesPerSample);
+		append<uint16_t> (bytes, static_cast<uint16_t> (bytesPerSample));
+		append<uint16_t> (bytes, static_cast<uint16_t> (bitsPerSample));
+		bytes.insert (bytes.end (), {'d', 'a', 't', 'a'});
+		append<uint32_t> (bytes, dataSize);
+	}
+	for (auto x : signal)
+	{
+		if (bitsPerSample == 64)
+			append (bytes, x);
+		else if (isFloat)
+			append (bytes, static_cast<float> (x));
+		else
+		{
+			auto scale = static_cast<double> ((1 << (bitsPerSample - 1)) - 1);
+			auto v = static_cast<int32_t> (std::round (std::clamp (x, -1., 1.) * scale));
+			append (bytes, v, bytesPerSample);
+		}
+	}
+
+	std::ofstream file (path, std::ios::binary);
+	file.write (reinterpret_cast<const char*> (bytes.data ()), bytes.size ());
+	return static_cast<bool> (file);
+}
+
+//------------------------------------------------------------------------
+std::optional<std::vector<uint8_t>> readFile (const std::string& path)
+{
+	std::ifstream file (path, std::ios::binary);
+	if (!file)
+		return {};
+	return {std::vector<uint8_t> (std::istreambuf_iterator<char> (file),
+								  std::istreambuf_iterator<char> ())};
+}
+
+//------------------------------------------------------------------------
+} // o303
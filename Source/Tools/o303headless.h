@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../DSPCode/rosic_Open303.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace o303 {
+
+//------------------------------------------------------------------------
+/** Loads the processor state of the plug-in into the synth: the parameters (as written by
+ *	saveParameterState) followed by the 16 sequencer patterns (as written by saveAcidPattern).
+ *	The data may also be a .vstpreset file, then the state is taken from its component chunk.
+ *	States with and without the extended parameter set are recognized by their parameter count.
+ */
+bool loadProcessorState (const std::vector<uint8_t>& data, rosic::Open303& synth,
+						 std::string& error);
+
+//------------------------------------------------------------------------
+struct RenderSettings
+{
+	double sampleRate {44100.};
+	double tempo {120.};
+	double bars {4.};
+	double tailSeconds {0.};
+	int pattern {-1}; // 0..15, -1 plays the active pattern of the state
+	int rootNote {36};
+	int velocity {100};
+};
+
+/** Returns the number of frames that render produces for the settings. */
+int64_t getRenderLength (const RenderSettings& settings);
+
+/** Plays the sequencer for the given number of bars (holding the root note in key sync mode)
+ *	and renders the output into the buffer (resized to getRenderLength) as fast as possible.
+ */
+void render (rosic::Open303& synth, const RenderSettings& settings, std::vector<double>& output);
+
+//------------------------------------------------------------------------
+struct RenderJob
+{
+	std::string statePath;
+	std::string outputPath;
+	RenderSettings settings;
+};
+
+/** Parses a batch manifest with one job per line: <state> <pattern> <tempo> <bars> <output>.
+ *	The pattern is 1..16 or 0 for the active pattern of the state, empty lines and lines starting
+ *	with # are ignored. Relative paths are relative to the manifest, the other settings of the
+ *	jobs are taken from the defaults.
+ */
+std::optional<std::vector<RenderJob>> parseManifest (const std::string& path,
+													 const RenderSettings& defaults,
+													 std::string& error);
+
+//------------------------------------------------------------------------
+enum class SampleFormat
+{
+	Wav16,
+	Wav24,
+	Wav32Float,
+	Raw32Float,
+	Raw64Float,
+};
+
+/** Parses the name of a sample format (wav16, wav24, wav32f, raw32f, raw64f). */
+std::optional<SampleFormat> parseSampleFormat (const std::string& name);
+
+/** Writes the mono signal to a WAV file or as raw little-endian samples. */
+bool writeAudioFile (const std::string& path, const std::vector<double>& signal,
+					 double sampleRate, SampleFormat format);
+
+/** Reads the whole file. */
+std::optional<std::vector<uint8_t>> readFile (const std::string& path);
+
+//------------------------------------------------------------------------
+} // o303
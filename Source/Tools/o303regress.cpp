@@ -0,0 +1,835 @@
+#include "../DSPCode/rosic_CpuDispatch.h"
+#include "../DSPCode/rosic_FourierTransformerRadix2.h"
+#include "../DSPCode/rosic_Open303xN.h"
+#include "../DSPCode/rosic_PostFilterChain.h"
+#include "../DSPCode/rosic_RealtimeAudit.h"
+#include "o303headless.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace {
+
+// the synth must be realtime-safe while it renders (@see renderSequence)
+#ifdef O303_RT_AUDIT
+// the tripwires of the library report the allocations, locks and blocking calls
+using AudioPathScope = rosic::RealtimeAudit::AudioThreadScope;
+int64_t getNumAudioPathViolations () { return rosic::RealtimeAudit::getNumViolations (); }
+#else
+// we count the allocations with the global operator new below
+thread_local bool inAudioPath = false;
+int64_t numAudioPathAllocations = 0;
+
+struct AudioPathScope
+{
+	AudioPathScope () { inAudioPath = true; }
+	~AudioPathScope () { inAudioPath = false; }
+};
+
+int64_t getNumAudioPathViolations () { return numAudioPathAllocations; }
+#endif
+
+} // anonymous
+
+#ifndef O303_RT_AUDIT
+//------------------------------------------------------------------------
+void* operator new (std::size_t size)
+{
+	if (inAudioPath)
+		++numAudioPathAllocations;
+	if (auto ptr = std::malloc (size > 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc ();
+}
+
+//------------------------------------------------------------------------
+void operator delete (void* ptr) noexcept { std::free (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept { std::free (ptr); }
+#endif
+
+//------------------------------------------------------------------------
+namespace {
+
+using namespace o303;
+
+//------------------------------------------------------------------------
+/** An event of a fixed note sequence: a note (velocity 0 is a note off, velocities of 100 and
+ *	above are accented, overlapping notes slide) or a parameter change at a time in seconds.
+ */
+struct Event
+{
+	enum Type
+	{
+		Note,
+		Cutoff,
+		Resonance,
+		EnvMod,
+		Decay,
+		Waveform,
+		PitchBend,
+	};
+
+	double time;
+	Type type;
+	double value;
+	int velocity {0};
+};
+
+using Sequence = std::vector<Event>;
+
+//------------------------------------------------------------------------
+struct TestCase
+{
+	std::string name;
+	double sampleRate;
+	std::function<void (std::vector<double>& output)> render;
+};
+
+//------------------------------------------------------------------------
+/** A check of a component against a reference implementation, which needs no reference file.
+ *	The output must be identical to the one of the reference implementation or, for checks with a
+ *	compare function, be within the peak error threshold (the spectral error is only reported).
+ */
+struct Check
+{
+	std::string name;
+	std::function<bool ()> run;
+	std::function<void (std::vector<double>& output, std::vector<double>& reference)> compare {};
+};
+
+//------------------------------------------------------------------------
+struct Options
+{
+	double maxError {-100.};		 // peak of the error relative to the peak of the reference
+	double maxSpectralError {-100.}; // magnitude spectrum error of the worst frame
+	bool bitExact {false};
+	std::string filter;
+};
+
+//------------------------------------------------------------------------
+struct Comparison
+{
+	double error;		  // in dB
+	double spectralError; // in dB
+	bool identical;
+};
+
+//------------------------------------------------------------------------
+static constexpr double minusInfinity = -std::numeric_limits<double>::infinity ();
+
+//------------------------------------------------------------------------
+// the parameters which the fixed sequences start with
+template<class Synth>
+void setupSynth (Synth& synth, double sampleRate)
+{
+	synth.setSampleRate (sampleRate);
+	synth.setWaveform (0.3);
+	synth.setCutoff (800.);
+	synth.setResonance (85.);
+	synth.setEnvMod (70.);
+	synth.setDecay (500.);
+	synth.setAccent (80.);
+	synth.setVolume (-6.);
+}
+
+//------------------------------------------------------------------------
+template<class Synth>
+void applyEvent (Synth& synth, const Event& event)
+{
+	switch (event.type)
+	{
+		case Event::Note: synth.noteOn (static_cast<int> (event.value), event.velocity); break;
+		case Event::Cutoff: synth.setCutoff (event.value); break;
+		case Event::Resonance: synth.setResonance (event.value); break;
+		case Event::EnvMod: synth.setEnvMod (event.value); break;
+		case Event::Decay: synth.setDecay (event.value); break;
+		case Event::Waveform: synth.setWaveform (event.value); break;
+		case Event::PitchBend: synth.setPitchBend (event.value); break;
+	}
+}
+
+//------------------------------------------------------------------------
+// renders in blocks of varying size which are split at the events, like a host would
+template<class Synth>
+void renderSequence (Synth& synth, const Sequence& sequence, double seconds, double sampleRate,
+					 std::vector<double>& output)
+{
+	static constexpr int blockSizes[] = {64, 1, 128, 37, 512, 5};
+
+	output.resize (static_cast<size_t> (std::round (seconds * sampleRate)));
+	auto event = sequence.begin ();
+	auto numFrames = static_cast<int64_t> (output.size ());
+	AudioPathScope audioPath;
+	for (int64_t pos = 0, block = 0; pos < numFrames; ++block)
+	{
+		for (; event != sequence.end () &&
+			   static_cast<int64_t> (std::round (event->time * sampleRate)) <= pos;
+			 ++event)
+			applyEvent (synth, *event);
+		auto end = std::min<int64_t> (numFrames, pos + blockSizes[block % std::size (blockSizes)]);
+		if (event != sequence.end ())
+			end = std::min (end, static_cast<int64_t> (std::round (event->time * sampleRate)));
+		synth.processBlock (output.data () + pos, static_cast<int> (end - pos));
+		pos = end;
+	}
+}
+
+//------------------------------------------------------------------------
+// short notes, accents, slides and pitch bends
+Sequence createNoteSequence ()
+{
+	return {
+		{0.00, Event::Note, 36, 80},   {0.20, Event::Note, 36, 0},	  {0.25, Event::Note, 48, 127},
+		{0.45, Event::Note, 48, 0},	   {0.50, Event::Note, 41, 90},	  {0.65, Event::Note, 43, 90},
+		{0.70, Event::Note, 41, 0},	   {0.85, Event::Note, 48, 120},  {0.90, Event::Note, 43, 0},
+		{1.05, Event::Note, 48, 0},	   {1.10, Event::Note, 29, 100},  {1.25, Event::PitchBend, 2.},
+		{1.50, Event::PitchBend, 0.},  {1.60, Event::Note, 29, 0},	  {1.70, Event::Note, 60, 127},
+		{1.72, Event::Note, 60, 0},	   {1.75, Event::Note, 24, 64},	  {1.95, Event::Note, 24, 0},
+	};
+}
+
+//------------------------------------------------------------------------
+// a held note (with one slide) while the parameters are automated every 10 ms
+Sequence createSweepSequence ()
+{
+	Sequence sequence {{0., Event::Note, 33, 100}};
+	for (auto i = 0; i <= 250; ++i)
+	{
+		auto time = i * 0.01;
+		auto x = i / 250.;
+		auto triangle = 1. - std::abs (2. * x - 1.);
+		sequence.push_back ({time, Event::Cutoff, 200. * std::pow (25., triangle)});
+		sequence.push_back ({time, Event::Resonance, 100. * x});
+		sequence.push_back ({time, Event::EnvMod, 100. * (1. - x)});
+		sequence.push_back ({time, Event::Waveform, x});
+		if (i == 120)
+			sequence.push_back ({time, Event::Note, 45, 127});
+		if (i == 121)
+			sequence.push_back ({time, Event::Note, 33, 0});
+	}
+	sequence.push_back ({2.5, Event::Note, 45, 0});
+	return sequence;
+}
+
+//------------------------------------------------------------------------
+// fills the 16 patterns with fixed pseudo random notes and sets parameters which depend on the
+// pattern, so that the patterns cover different regions of the parameter space
+void setupPattern (rosic::Open303& synth, int index)
+{
+	unsigned int state = 12345 + 7919 * index;
+	auto random = [&] () {
+		state = 1664525 * state + 1013904223;
+		return state / 4294967296.;
+	};
+	for (auto p = 0; p < synth.sequencer.getNumPatterns (); ++p)
+	{
+		auto& pattern = *synth.sequencer.getPattern (p);
+		pattern.setNumSteps (p % 4 == 3 ? 12 : 16);
+		pattern.setStepLength (0.3 + 0.2 * (p % 3));
+		for (auto step = 0; step < pattern.getMaxNumSteps (); ++step)
+		{
+			pattern.setKey (step, static_cast<int> (random () * 12.));
+			pattern.setOctave (step, static_cast<int> (random () * 3.) - 1);
+			pattern.setAccent (step, random () < 0.25);
+			pattern.setSlide (step, random () < 0.2);
+			pattern.setGate (step, random () < 0.8);
+		}
+	}
+	synth.setWaveform (random ());
+	synth.setCutoff (314. * std::pow (2394. / 314., random ()));
+	synth.setResonance (100. * random ());
+	synth.setEnvMod (100. * random ());
+	synth.setDecay (200. * std::pow (10., random ()));
+	synth.setAccent (100. * random ());
+	synth.setVolume (-6.);
+}
+
+//------------------------------------------------------------------------
+std::string getCaseName (const std::string& base, double sampleRate)
+{
+	return base + "_" + std::to_string (static_cast<int> (sampleRate));
+}
+
+//------------------------------------------------------------------------
+std::vector<TestCase> createTestCases ()
+{
+	static constexpr double sampleRates[] = {44100., 48000., 96000.};
+
+	std::vector<TestCase> cases;
+	for (auto sampleRate : sampleRates)
+	{
+		cases.push_back ({getCaseName ("notes", sampleRate), sampleRate,
+						  [sampleRate] (std::vector<double>& output) {
+							  auto synth = std::make_unique<rosic::Open303> ();
+							  setupSynth (*synth, sampleRate);
+							  renderSequence (*synth, createNoteSequence (), 2.5, sampleRate,
+											  output);
+						  }});
+		cases.push_back ({getCaseName ("sweep", sampleRate), sampleRate,
+						  [sampleRate] (std::vector<double>& output) {
+							  auto synth = std::make_unique<rosic::Open303> ();
+							  setupSynth (*synth, sampleRate);
+							  renderSequence (*synth, createSweepSequence (), 3., sampleRate,
+											  output);
+						  }});
+	}
+
+	// the other signal paths of the synth
+	cases.push_back ({"notes_float_44100", 44100., [] (std::vector<double>& output) {
+						  auto synth = std::make_unique<rosic::Open303Float> ();
+						  setupSynth (*synth, 44100.);
+						  renderSequence (*synth, createNoteSequence (), 2.5, 44100., output);
+					  }});
+	for (auto oversampling : {1, 2, 8})
+	{
+		cases.push_back ({"notes_os" + std::to_string (oversampling) + "_44100", 44100.,
+						  [oversampling] (std::vector<double>& output) {
+							  auto synth = std::make_unique<rosic::Open303> ();
+							  synth->setOversampling (oversampling);
+							  setupSynth (*synth, 44100.);
+							  renderSequence (*synth, createNoteSequence (), 2.5, 44100., output);
+						  }});
+	}
+	cases.push_back ({"notes_halfband_44100", 44100., [] (std::vector<double>& output) {
+						  auto synth = std::make_unique<rosic::Open303> ();
+						  synth->setAntiAliasFilter (rosic::Open303::HALFBAND_HIGH);
+						  setupSynth (*synth, 44100.);
+						  renderSequence (*synth, createNoteSequence (), 2.5, 44100., output);
+					  }});
+	cases.push_back ({"notes_polyblep_os2_44100", 44100., [] (std::vector<double>& output) {
+						  auto synth = std::make_unique<rosic::Open303> ();
+						  synth->setOversampling (2);
+						  synth->setOscillatorAlgorithm (rosic::BlendOscillator::POLY_BLEP);
+						  setupSynth (*synth, 44100.);
+						  renderSequence (*synth, createNoteSequence (), 2.5, 44100., output);
+					  }});
+
+	for (auto sampleRate : sampleRates)
+	{
+		for (auto pattern = 0; pattern < 16; ++pattern)
+		{
+			char base[16];
+			std::snprintf (base, sizeof (base), "pattern%02d", pattern + 1);
+			cases.push_back ({getCaseName (base, sampleRate), sampleRate,
+							  [sampleRate, pattern] (std::vector<double>& output) {
+								  auto synth = std::make_unique<rosic::Open303> ();
+								  setupPattern (*synth, pattern);
+								  RenderSettings settings;
+								  settings.sampleRate = sampleRate;
+								  settings.tempo = 130.;
+								  settings.bars = 1.;
+								  settings.tailSeconds = 0.3;
+								  settings.pattern = pattern;
+								  render (*synth, settings, output);
+							  }});
+		}
+	}
+	return cases;
+}
+
+//------------------------------------------------------------------------
+// feeds noise with random gains through the block processing of the post filter chain (in blocks
+// of random lengths) and through its per sample processing, the outputs must be identical
+template<typename T, typename TOut>
+bool postFilterChainIsExact ()
+{
+	static constexpr int numSamples = 1 << 16;
+
+	unsigned int state = 4711;
+	auto random = [&] () {
+		state = 1664525 * state + 1013904223;
+		return state / 4294967296.;
+	};
+	std::vector<T> input (numSamples);
+	std::vector<double> amp (numSamples), gain (numSamples);
+	for (auto n = 0; n < numSamples; ++n)
+	{
+		input[n] = static_cast<T> (2. * random () - 1.);
+		amp[n] = random ();
+		gain[n] = 2. * random ();
+	}
+
+	rosic::PostFilterChainT<T> block, reference;
+	for (auto* chain : {&block, &reference})
+	{
+		chain->setSampleRate (44100.);
+		chain->setHighpassCutoff (24.167);
+		chain->setAllpassCutoff (14.008);
+		chain->setNotchFrequency (7.5164);
+		chain->setNotchBandwidth (4.7);
+	}
+
+	std::vector<T> buffer (input);
+	std::vector<TOut> output (numSamples), expected (numSamples);
+	auto constantGain = 0.5;
+	for (auto start = 0; start < numSamples;)
+	{
+		auto length = std::min (1 + static_cast<int> (random () * 256.), numSamples - start);
+		auto ramping = random () < 0.5;
+		block.processBlock (buffer.data () + start, amp.data () + start,
+							ramping ? gain.data () + start : nullptr, constantGain,
+							output.data () + start, length);
+		for (auto n = start; n < start + length; ++n)
+			expected[n] = static_cast<TOut> (reference.getSample (input[n]) * amp[n] *
+											  (ramping ? gain[n] : constantGain));
+		start += length;
+	}
+	return std::memcmp (output.data (), expected.data (), numSamples * sizeof (TOut)) == 0;
+}
+
+//------------------------------------------------------------------------
+// renders the note sequence and 8 held notes in lockstep (Open303x8) with each instruction set that
+// the CPU supports (@see CpuDispatch), the outputs must be identical to the ones of the baseline
+// variant
+bool instructionSetsAreExact ()
+{
+	using rosic::CpuDispatch;
+	static constexpr int numLanes = 8;
+	static constexpr int numFrames = 44100;
+	static constexpr int blockSize = 64;
+
+	auto selected = CpuDispatch::getInstructionSet ();
+	std::vector<double> reference, output;
+	auto passed = true;
+	for (auto instructionSet = 0; instructionSet <= CpuDispatch::getDetectedInstructionSet ();
+		 ++instructionSet)
+	{
+		CpuDispatch::setInstructionSet (instructionSet);
+		auto synth = std::make_unique<rosic::Open303> ();
+		setupSynth (*synth, 44100.);
+		renderSequence (*synth, createNoteSequence (), 2.5, 44100., output);
+
+		auto synths = std::make_unique<rosic::Open303x8> ();
+		std::vector<double> lanes (numLanes * numFrames);
+		for (auto v = 0; v < numLanes; ++v)
+		{
+			setupSynth (synths->voices[v], 44100.);
+			synths->voices[v].setCutoff (300. + 200. * v);
+			synths->voices[v].noteOn (36 + v, 64 + 8 * v);
+		}
+		for (auto pos = 0; pos < numFrames; pos += blockSize)
+		{
+			double* out[numLanes];
+			for (auto v = 0; v < numLanes; ++v)
+				out[v] = lanes.data () + v * numFrames + pos;
+			synths->processBlock (out, std::min (blockSize, numFrames - pos));
+		}
+		output.insert (output.end (), lanes.begin (), lanes.end ());
+
+		if (instructionSet == CpuDispatch::BASELINE)
+			reference = output;
+		else
+			passed = passed && output == reference;
+	}
+	CpuDispatch::setInstructionSet (selected);
+	return passed;
+}
+
+//------------------------------------------------------------------------
+// renders the note sequence with high resonance and full envmod through Open303Float and through
+// Open303 as the reference, the peak error must be within the threshold (@see Open303T)
+template<int oversampling, int antiAliasFilter>
+void renderFloatAndDouble (std::vector<double>& output, std::vector<double>& reference)
+{
+	auto render = [] (auto& synth, std::vector<double>& out) {
+		synth.setOversampling (oversampling);
+		synth.setAntiAliasFilter (antiAliasFilter);
+		setupSynth (synth, 44100.);
+		synth.setResonance (95.);
+		synth.setEnvMod (100.);
+		renderSequence (synth, createNoteSequence (), 2.5, 44100., out);
+	};
+	auto synth = std::make_unique<rosic::Open303Float> ();
+	render (*synth, output);
+	auto referenceSynth = std::make_unique<rosic::Open303> ();
+	render (*referenceSynth, reference);
+}
+
+//------------------------------------------------------------------------
+// sets up the instance of a lane for lanesAreExact, most lanes fall back to individual rendering
+void setupLane (rosic::Open303& synth, int lane)
+{
+	setupSynth (synth, 44100.);
+	synth.setCutoff (300. + 150. * lane);
+	switch (lane)
+	{
+		case 2: synth.filter.setMode (rosic::TeeBeeFilter::LP_24); break;
+		case 3: synth.setOversampling (2); break;
+		case 4: synth.setSmoothingTime (200.); break;
+		case 5: synth.setAntiAliasFilter (rosic::Open303::HALFBAND_HIGH); break;
+		case 6: synth.setOscillatorAlgorithm (rosic::BlendOscillator::POLY_BLEP); break;
+	}
+}
+
+//------------------------------------------------------------------------
+// applies the events up to the time to all lanes but the idle lane 1, lane 0 switches between
+// lockstep and individual rendering with its filter mode and lane 4 ramps its waveform
+void applyLaneEvents (rosic::Open303& synth, int lane, const Sequence& sequence, size_t& next,
+					  double time)
+{
+	for (; next < sequence.size () && sequence[next].time <= time; ++next)
+	{
+		auto event = sequence[next];
+		if (lane == 1)
+			continue;
+		if (event.type == Event::Note)
+			event.value += lane;
+		applyEvent (synth, event);
+		if (lane == 0 && event.type == Event::Note && event.value == 41 + lane)
+			synth.filter.setMode (event.velocity > 0 ? rosic::TeeBeeFilter::LP_18
+													 : rosic::TeeBeeFilter::TB_303);
+		if (lane == 4 && event.type == Event::Note && event.velocity > 0)
+			synth.setParameterSmoothly (rosic::Open303::WAVEFORM, event.velocity / 127.);
+	}
+}
+
+//------------------------------------------------------------------------
+// renders the note sequence on the lanes of an Open303xN and on the same number of Open303
+// instances with their own processBlock, the outputs must be identical
+template<int numLanes>
+bool lanesAreExact ()
+{
+	static constexpr int blockSizes[] = {64, 1, 128, 37, 512, 5};
+	static constexpr int numFrames = 2 * 44100;
+
+	auto synths = std::make_unique<rosic::Open303xN<numLanes>> ();
+	auto references = std::make_unique<rosic::Open303[]> (numLanes);
+	for (auto v = 0; v < numLanes; ++v)
+	{
+		setupLane (synths->voices[v], v % 8);
+		setupLane (references[v], v % 8);
+	}
+
+	auto sequence = createNoteSequence ();
+	std::vector<size_t> next (numLanes, 0), referenceNext (numLanes, 0);
+	std::vector<double> lanes (numLanes * numFrames), expected (numLanes * numFrames);
+	for (auto pos = 0, block = 0; pos < numFrames; ++block)
+	{
+		auto length = std::min (blockSizes[block % std::size (blockSizes)], numFrames - pos);
+		double* out[numLanes];
+		for (auto v = 0; v < numLanes; ++v)
+		{
+			applyLaneEvents (synths->voices[v], v % 8, sequence, next[v], pos / 44100.);
+			applyLaneEvents (references[v], v % 8, sequence, referenceNext[v], pos / 44100.);
+			out[v] = lanes.data () + v * numFrames + pos;
+			references[v].processBlock (expected.data () + v * numFrames + pos, length);
+		}
+		synths->processBlock (out, length);
+		pos += length;
+	}
+	return std::memcmp (lanes.data (), expected.data (), lanes.size () * sizeof (double)) == 0;
+}
+
+//------------------------------------------------------------------------
+std::vector<Check> createChecks ()
+{
+	return {
+		{"postfilters_double", postFilterChainIsExact<double, double>},
+		{"postfilters_float", postFilterChainIsExact<float, float>},
+		{"float_os4_elliptic", {}, renderFloatAndDouble<4, rosic::Open303::ELLIPTIC>},
+		{"float_os4_halfband", {}, renderFloatAndDouble<4, rosic::Open303::HALFBAND_HIGH>},
+		{"float_os8_elliptic", {}, renderFloatAndDouble<8, rosic::Open303::ELLIPTIC>},
+		{"float_os8_halfband", {}, renderFloatAndDouble<8, rosic::Open303::HALFBAND_HIGH>},
+		{"lanes_x4", lanesAreExact<4>},
+		{"lanes_x8", lanesAreExact<8>},
+		{"instruction_sets", instructionSetsAreExact},
+	};
+}
+
+//------------------------------------------------------------------------
+double toDecibels (double ratio)
+{
+	return ratio > 0. ? 20. * std::log10 (ratio) : minusInfinity;
+}
+
+//------------------------------------------------------------------------
+// the error of the magnitude spectra (Hann windowed frames) relative to the reference of the
+// worst frame, frames which are more than 100 dB below the loudest one count as that level
+double getSpectralError (const std::vector<double>& signal, const std::vector<double>& reference)
+{
+	static constexpr int frameSize = 2048;
+	static constexpr int hopSize = frameSize / 2;
+
+	rosic::FourierTransformerRadix2 transformer;
+	transformer.setBlockSize (frameSize);
+	std::vector<double> window (frameSize), frame (frameSize), magnitudes (frameSize / 2),
+		referenceMagnitudes (frameSize / 2);
+	for (auto i = 0; i < frameSize; ++i)
+		window[i] = 0.5 - 0.5 * std::cos (2. * PI * i / frameSize);
+
+	std::vector<double> errorEnergies, referenceEnergies;
+	for (size_t pos = 0; pos < reference.size (); pos += hopSize)
+	{
+		auto getMagnitudes = [&] (const std::vector<double>& s, std::vector<double>& m) {
+			for (auto i = 0u; i < frameSize; ++i)
+				frame[i] = pos + i < s.size () ? s[pos + i] * window[i] : 0.;
+			transformer.getRealSignalMagnitudes (frame.data (), m.data ());
+		};
+		getMagnitudes (signal, magnitudes);
+		getMagnitudes (reference, referenceMagnitudes);
+		double errorEnergy = 0., referenceEnergy = 0.;
+		for (auto k = 0; k < frameSize / 2; ++k)
+		{
+			auto d = magnitudes[k] - referenceMagnitudes[k];
+			errorEnergy += d * d;
+			referenceEnergy += referenceMagnitudes[k] * referenceMagnitudes[k];
+		}
+		errorEnergies.push_back (errorEnergy);
+		referenceEnergies.push_back (referenceEnergy);
+	}
+
+	auto floor = *std::max_element (referenceEnergies.begin (), referenceEnergies.end ()) * 1e-10;
+	double worst = 0.;
+	for (auto i = 0u; i < errorEnergies.size (); ++i)
+	{
+		auto energy = std::max (referenceEnergies[i], floor);
+		if (energy > 0.)
+			worst = std::max (worst, errorEnergies[i] / energy);
+		else if (errorEnergies[i] > 0.)
+			return std::numeric_limits<double>::infinity ();
+	}
+	return worst > 0. ? 10. * std::log10 (worst) : minusInfinity;
+}
+
+//------------------------------------------------------------------------
+Comparison compare (const std::vector<double>& signal, const std::vector<double>& reference)
+{
+	double maxError = 0., peak = 0.;
+	for (auto i = 0u; i < reference.size (); ++i)
+	{
+		maxError = std::max (maxError, std::abs (signal[i] - reference[i]));
+		peak = std::max (peak, std::abs (reference[i]));
+	}
+	Comparison result;
+	result.identical = std::memcmp (signal.data (), reference.data (),
+									reference.size () * sizeof (double)) == 0;
+	if (peak > 0.)
+		result.error = toDecibels (maxError / peak);
+	else
+		result.error = maxError > 0. ? std::numeric_limits<double>::infinity () : minusInfinity;
+	result.spectralError = getSpectralError (signal, reference);
+	return result;
+}
+
+//------------------------------------------------------------------------
+std::optional<std::vector<double>> readReference (const std::string& path)
+{
+	auto data = readFile (path);
+	if (!data || data->size () % sizeof (double) != 0)
+		return {};
+	std::vector<double> result (data->size () / sizeof (double));
+	for (auto i = 0u; i < result.size (); ++i)
+	{
+		uint64_t bits = 0;
+		for (auto b = 0u; b < sizeof (double); ++b)
+			bits |= static_cast<uint64_t> ((*data)[i * sizeof (double) + b]) << (8 * b);
+		std::memcpy (&result[i], &bits, sizeof (double));
+	}
+	return {std::move (result)};
+}
+
+//------------------------------------------------------------------------
+std::string formatDecibels (double value)
+{
+	char text[32];
+	if (std::isinf (value))
+		std::snprintf (text, sizeof (text), value < 0. ? "-inf" : "inf");
+	else
+		std::snprintf (text, sizeof (text), "%.1f", value);
+	return text;
+}
+
+//------------------------------------------------------------------------
+void printUsage ()
+{
+	std::fprintf (stderr,
+				  "usage: o303regress [options] <reference directory> [filter]\n"
+				  "       o303regress --generate <reference directory> [filter]\n"
+				  "\n"
+				  "Renders fixed note sequences and the 16 sequencer patterns at several sample\n"
+				  "rates and compares them to the reference renders in the directory (or writes\n"
+				  "the references with --generate). Only the cases whose names contain the filter\n"
+				  "string are rendered. A case also fails when the synth allocates memory while\n"
+				  "it processes the events and blocks (or, in builds with O303_RT_AUDIT, locks a\n"
+				  "mutex or makes a blocking system call). Then the block processing of single\n"
+				  "components is checked against their per sample processing and the lanes of\n"
+				  "Open303x4/x8 against individually rendered instances, which must give\n"
+				  "identical output, and Open303Float against Open303, which must stay within\n"
+				  "the maximum error.\n"
+				  "\n"
+				  "options:\n"
+				  "  --max-error <dB>           maximum peak error relative to the peak of the\n"
+				  "                             reference (-100)\n"
+				  "  --max-spectral-error <dB>  maximum error of the magnitude spectrum relative\n"
+				  "                             to the reference in any frame (-100)\n"
+				  "  --bit-exact                require identical output\n"
+				  "  --isa <name>               render with the kernels for this instruction set\n"
+				  "                             (baseline, avx2 or avx512)\n"
+				  "  -l, --list                 list the test cases\n");
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	Options options;
+	std::string directory;
+	bool generate = false;
+	auto cases = createTestCases ();
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		auto hasValue = i + 1 < argc;
+		if (arg == "--max-error" && hasValue)
+			options.maxError = std::atof (argv[++i]);
+		else if (arg == "--max-spectral-error" && hasValue)
+			options.maxSpectralError = std::atof (argv[++i]);
+		else if (arg == "--bit-exact")
+			options.bitExact = true;
+		else if (arg == "--isa" && hasValue)
+		{
+			auto instructionSet = rosic::CpuDispatch::findInstructionSet (argv[++i]);
+			if (instructionSet < 0)
+			{
+				std::fprintf (stderr, "unknown instruction set %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+			rosic::CpuDispatch::setInstructionSet (instructionSet);
+		}
+		else if (arg == "--generate")
+			generate = true;
+		else if (arg == "-l" || arg == "--list")
+		{
+			for (const auto& testCase : cases)
+				std::fprintf (stdout, "%s\n", testCase.name.c_str ());
+			return EXIT_SUCCESS;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage ();
+			return EXIT_SUCCESS;
+		}
+		else if (!arg.empty () && arg[0] != '-' && directory.empty ())
+			directory = arg;
+		else if (!arg.empty () && arg[0] != '-' && options.filter.empty ())
+			options.filter = arg;
+		else
+		{
+			printUsage ();
+			return EXIT_FAILURE;
+		}
+	}
+	if (directory.empty ())
+	{
+		printUsage ();
+		return EXIT_FAILURE;
+	}
+
+	std::error_code ec;
+	if (generate && !std::filesystem::create_directories (directory, ec) && ec)
+	{
+		std::fprintf (stderr, "can't create %s\n", directory.c_str ());
+		return EXIT_FAILURE;
+	}
+
+	if (!generate)
+		std::fprintf (stdout, "%-24s %10s %10s  %s\n", "case", "error", "spectral", "result");
+	auto numFailed = 0;
+	auto numCases = 0;
+	std::vector<double> output;
+	for (const auto& testCase : cases)
+	{
+		if (testCase.name.find (options.filter) == std::string::npos)
+			continue;
+		++numCases;
+		auto path = (std::filesystem::path (directory) / (testCase.name + ".f64")).string ();
+		auto numViolations = getNumAudioPathViolations ();
+		testCase.render (output);
+		numViolations = getNumAudioPathViolations () - numViolations;
+
+		if (generate)
+		{
+			if (!writeAudioFile (path, output, testCase.sampleRate, SampleFormat::Raw64Float))
+			{
+				std::fprintf (stderr, "can't write %s\n", path.c_str ());
+				return EXIT_FAILURE;
+			}
+			std::fprintf (stdout, "%s\n", path.c_str ());
+			continue;
+		}
+
+		auto reference = readReference (path);
+		if (!reference || reference->size () != output.size ())
+		{
+			++numFailed;
+			std::fprintf (stdout, "%-24s %10s %10s  FAIL (%s)\n", testCase.name.c_str (), "", "",
+						  reference ? "length differs" : "no reference");
+			continue;
+		}
+		if (numViolations > 0)
+		{
+			++numFailed;
+			std::fprintf (stdout, "%-24s %10s %10s  FAIL (%lld realtime violations)\n",
+						  testCase.name.c_str (), "", "", static_cast<long long> (numViolations));
+			continue;
+		}
+		auto result = compare (output, *reference);
+		bool passed = options.bitExact ? result.identical
+									   : result.error <= options.maxError &&
+											 result.spectralError <= options.maxSpectralError;
+		if (!passed)
+			++numFailed;
+		std::fprintf (stdout, "%-24s %10s %10s  %s\n", testCase.name.c_str (),
+					  formatDecibels (result.error).c_str (),
+					  formatDecibels (result.spectralError).c_str (),
+					  passed ? (result.identical ? "ok (identical)" : "ok") : "FAIL");
+	}
+
+	if (!generate)
+	{
+		for (const auto& check : createChecks ())
+		{
+			if (check.name.find (options.filter) == std::string::npos)
+				continue;
+			++numCases;
+			if (check.compare)
+			{
+				std::vector<double> reference;
+				check.compare (output, reference);
+				auto result = compare (output, reference);
+				auto passed = output.size () == reference.size () && result.error <= options.maxError;
+				if (!passed)
+					++numFailed;
+				std::fprintf (stdout, "%-24s %10s %10s  %s\n", check.name.c_str (),
+							  formatDecibels (result.error).c_str (),
+							  formatDecibels (result.spectralError).c_str (),
+							  passed ? "ok" : "FAIL");
+				continue;
+			}
+			auto passed = check.run ();
+			if (!passed)
+				++numFailed;
+			std::fprintf (stdout, "%-24s %10s %10s  %s\n", check.name.c_str (), "", "",
+						  passed ? "ok (identical)" : "FAIL");
+		}
+	}
+
+	if (generate)
+		std::fprintf (stdout, "%d references written\n", numCases);
+	else
+		std::fprintf (stdout, "%d of %d cases passed\n", numCases - numFailed, numCases);
+	return numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,216 @@
+#include "o303headless.h"
+#include "o303workstealingpool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+void printUsage ()
+{
+	std::fprintf (stderr,
+				  "usage: o303render [options] <state> <output>\n"
+				  "\n"
+				  "Renders the sequencer of a plug-in state (or .vstpreset) to an audio file.\n"
+				  "\n"
+				  "options:\n"
+				  "  -r, --samplerate <Hz>  sample rate (44100)\n"
+				  "  -t, --tempo <bpm>      tempo (120)\n"
+				  "  -b, --bars <n>         number of bars to play (4)\n"
+				  "  -p, --pattern <1-16>   pattern to play (the active pattern of the state)\n"
+				  "  -n, --note <0-127>     root note for the sequencer (36)\n"
+				  "      --tail <seconds>   time to render after the end of the last bar (0)\n"
+				  "  -f, --format <format>  wav16, wav24, wav32f, raw32f or raw64f (wav24 for\n"
+				  "                         .wav files, raw32f otherwise)\n");
+}
+
+//------------------------------------------------------------------------
+bool endsWith (const std::string& str, const std::string& suffix)
+{
+	return str.size () >= suffix.size () &&
+		   str.compare (str.size () - suffix.size (), suffix.size (), suffix) == 0;
+}
+
+//------------------------------------------------------------------------
+struct JobResult
+{
+	double seconds {0.};
+	double elapsed {0.};
+	std::string error;
+};
+
+//------------------------------------------------------------------------
+JobResult renderJob (const o303::RenderJob& job, std::optional<o303::SampleFormat> format)
+{
+	using namespace o303;
+
+	JobResult result;
+	auto start = std::chrono::steady_clock::now ();
+	auto data = readFile (job.statePath);
+	if (!data)
+	{
+		result.error = "can't read " + job.statePath;
+		return result;
+	}
+	auto synth = std::make_unique<rosic::Open303> ();
+	if (!loadProcessorState (*data, *synth, result.error))
+	{
+		result.error = job.statePath + ": " + result.error;
+		return result;
+	}
+	std::vector<double> output;
+	render (*synth, job.settings, output);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+
+	if (!format)
+		format = endsWith (job.outputPath, ".wav") ? SampleFormat::Wav24 : SampleFormat::Raw32Float;
+	if (!writeAudioFile (job.outputPath, output, job.settings.sampleRate, *format))
+	{
+		result.error = "can't write " + job.outputPath;
+		return result;
+	}
+	result.seconds = output.size () / job.settings.sampleRate;
+	result.elapsed = elapsed.count ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+double getRealtimeFactor (double seconds, double elapsed)
+{
+	return seconds / std::max (elapsed, 1e-9);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace o303;
+
+	RenderSettings settings;
+	std::optional<SampleFormat> format;
+	std::string inputPath, outputPath, manifestPath;
+	auto numThreads = WorkStealingPool::getNumHardwareThreads ();
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		auto hasValue = i + 1 < argc;
+		auto value = [&] () { return std::atof (argv[++i]); };
+		if ((arg == "-r" || arg == "--samplerate") && hasValue)
+			settings.sampleRate = value ();
+		else if ((arg == "-t" || arg == "--tempo") && hasValue)
+			settings.tempo = value ();
+		else if ((arg == "-b" || arg == "--bars") && hasValue)
+			settings.bars = value ();
+		else if ((arg == "-p" || arg == "--pattern") && hasValue)
+			settings.pattern = static_cast<int> (value ()) - 1;
+		else if ((arg == "-n" || arg == "--note") && hasValue)
+			settings.rootNote = static_cast<int> (value ());
+		else if (arg == "--tail" && hasValue)
+			settings.tailSeconds = value ();
+		else if ((arg == "-f" || arg == "--format") && hasValue)
+		{
+			format = parseSampleFormat (argv[++i]);
+			if (!format)
+			{
+				std::fprintf (stderr, "unknown format: %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+		}
+		else if ((arg == "-j" || arg == "--jobs") && hasValue)
+			numThreads = static_cast<size_t> (std::max (1, std::atoi (argv[++i])));
+		else if (arg == "--batch" && hasValue)
+			manifestPath = argv[++i];
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage ();
+			return EXIT_SUCCESS;
+		}
+		else if (!arg.empty () && arg[0] != '-' && inputPath.empty ())
+			inputPath = arg;
+		else if (!arg.empty () && arg[0] != '-' && outputPath.empty ())
+			outputPath = arg;
+		else
+		{
+			printUsage ();
+			return EXIT_FAILURE;
+		}
+	}
+	if (manifestPath.empty () == (inputPath.empty () || outputPath.empty ()) ||
+		(!manifestPath.empty () && !inputPath.empty ()))
+	{
+		printUsage ();
+		return EXIT_FAILURE;
+	}
+	if (settings.sampleRate <= 0. || settings.tempo <= 0. || settings.bars < 0. ||
+		settings.tailSeconds < 0. || settings.pattern < -1 || settings.pattern > 15 ||
+		settings.rootNote < 0 || settings.rootNote > 127)
+	{
+		std::fprintf (stderr, "invalid render settings\n");
+		return EXIT_FAILURE;
+	}
+
+	if (manifestPath.empty ())
+	{
+		auto result = renderJob ({inputPath, outputPath, settings}, format);
+		if (!result.error.empty ())
+		{
+			std::fprintf (stderr, "%s\n", result.error.c_str ());
+			return EXIT_FAILURE;
+		}
+		std::fprintf (stdout, "%s: %.2f s rendered in %.3f s (%.0fx realtime)\n",
+					  outputPath.c_str (), result.seconds, result.elapsed,
+					  getRealtimeFactor (result.seconds, result.elapsed));
+		return EXIT_SUCCESS;
+	}
+
+	std::string error;
+	auto jobs = parseManifest (manifestPath, settings, error);
+	if (!jobs)
+	{
+		std::fprintf (stderr, "%s: %s\n", manifestPath.c_str (), error.c_str ());
+		return EXIT_FAILURE;
+	}
+
+	std::mutex outputMutex;
+	std::atomic<int> numFailed {0};
+	double totalSeconds = 0.;
+	std::vector<WorkStealingPool::Task> tasks;
+	for (auto index = 0u; index < jobs->size (); ++index)
+	{
+		tasks.emplace_back ([&, index] () {
+			const auto& job = (*jobs)[index];
+			auto result = renderJob (job, format);
+			std::lock_guard<std::mutex> lock (outputMutex);
+			if (!result.error.empty ())
+			{
+				++numFailed;
+				std::fprintf (stderr, "job %u: %s\n", index + 1, result.error.c_str ());
+				return;
+			}
+			totalSeconds += result.seconds;
+			std::fprintf (stdout, "job %u: %s: %.2f s rendered in %.3f s (%.0fx realtime)\n",
+						  index + 1, job.outputPath.c_str (), result.seconds, result.elapsed,
+						  getRealtimeFactor (result.seconds, result.elapsed));
+		});
+	}
+	auto start = std::chrono::steady_clock::now ();
+	WorkStealingPool::run (std::move (tasks), numThreads);
+	std::chrono::duration<double> wallTime = std::chrono::steady_clock::now () - start;
+
+	std::fprintf (stdout, "%zu jobs (%d failed), %.2f s rendered in %.3f s wall time on %zu "
+						  "threads (%.0fx realtime)\n",
+				  jobs->size (), numFailed.load (), totalSeconds, wallTime.count (),
+				  std::min (numThreads, std::max<size_t> (jobs->size (), 1)),
+				  getRealtimeFactor (totalSeconds, wallTime.count ()));
+	return numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace o303 {
+
+//------------------------------------------------------------------------
+/** Runs a batch of independent tasks on a pool of threads.
+ *
+ *	The tasks are dealt out to one queue per thread up front. Every thread works through its own
+ *	queue from the front and, when that is empty, steals from the back of the other queues, so
+ *	that threads which got the short tasks help out the ones which got the long tasks.
+ */
+class WorkStealingPool
+{
+public:
+	using Task = std::function<void ()>;
+
+	/** Runs all tasks and returns when they are done. */
+	static void run (std::vector<Task>&& tasks, size_t numThreads)
+	{
+		numThreads = std::clamp<size_t> (numThreads, 1, std::max<size_t> (tasks.size (), 1));
+		WorkStealingPool pool (numThreads);
+		for (auto i = 0u; i < tasks.size (); ++i)
+			pool.queues[i % numThreads]->tasks.push_back (std::move (tasks[i]));
+
+		std::vector<std::thread> threads;
+		for (auto i = 1u; i < numThreads; ++i)
+			threads.emplace_back ([&pool, i] () { pool.work (i); });
+		pool.work (0);
+		for (auto& thread : threads)
+			thread.join ();
+	}
+
+	/** Returns the number of threads the hardware runs concurrently. */
+	static size_t getNumHardwareThreads ()
+	{
+		return std::max (std::thread::hardware_concurrency (), 1u);
+	}
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	explicit WorkStealingPool (size_t numThreads)
+	{
+		for (auto i = 0u; i < numThreads; ++i)
+			queues.emplace_back (std::make_unique<Queue> ());
+	}
+
+	void work (size_t index)
+	{
+		// no tasks are added while running, so the first time all queues are empty we're done
+		while (auto task = pop (index))
+			(*task) ();
+	}
+
+	std::optional<Task> pop (size_t index)
+	{
+		for (auto i = 0u; i < queues.size (); ++i)
+		{
+			auto& queue = *queues[(index + i) % queues.size ()];
+			std::lock_guard<std::mutex> lock (queue.mutex);
+			if (queue.tasks.empty ())
+				continue;
+			Task task;
+			if (i == 0)
+			{
+				task = std::move (queue.tasks.front ());
+				queue.tasks.pop_front ();
+			}
+			else
+			{
+				task = std::move (queue.tasks.back ());
+				queue.tasks.pop_back ();
+			}
+			return {std::move (task)};
+		}
+		return {};
+	}
+
+	std::vector<std::unique_ptr<Queue>> queues;
+};
+
+//------------------------------------------------------------------------
+} // o303
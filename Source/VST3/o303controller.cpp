@@ -593,7 +593,10 @@ std::optional<Parameters> loadParameterState (Steinberg::IBStream* stream)
 	uint32 numParameters;
 	if (!s.readInt32u (numParameters) || numParameters == 0)
 		return {};
+	// parameters that are missing in states of older versions keep their defaults
 	Parameters result;
+	for (auto index = 0u; index < result.size (); ++index)
+		result[index].set (parameterDescriptions[index].default_normalized);
 	for (auto& p : result)
 	{
 		double value;
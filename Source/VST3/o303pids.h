@@ -62,6 +62,9 @@ enum class ParameterID
 	Square_Phase_Shift,
 #endif
 
+	Oversampling,
+	Oscillator,
+
 	enum_end,
 };
 using Parameters = vst3utils::enum_array<vst3utils::smooth_value<double>, ParameterID>;
@@ -78,6 +81,10 @@ static const constexpr std::array FilterTypeStrings = {
 static const constexpr std::array DecayModeStrings = {u"Original", u"Extended"};
 
 static const constexpr std::array SeqChordFollowStrings = {u"Off", u"Scale", u"Chord"};
+
+static const constexpr std::array OversamplingStrings = {u"1x", u"2x", u"4x", u"8x"};
+
+static const constexpr std::array OscillatorStrings = {u"Mip-Map", u"PolyBLEP"};
 static constexpr auto MaxSeqPatternSteps = 16u;
 
 using vst3utils::param::range;
@@ -123,6 +130,9 @@ static constexpr std::array<vst3utils::param::description, Parameters::count ()>
 			{range_description (u"post-filter hpf", 24., exponent_functions<10, 500> (), 0)},
 			{range_description (u"square phase shift", 180, linear_functions<0, 360> (), 0)},
 #endif // O303_EXTENDED_PARAMETERS
+
+			{list_description (u"oversampling", 2, OversamplingStrings)},
+			{list_description (u"oscillator", 0, OscillatorStrings)},
 		 }
 };
 
@@ -1,4 +1,5 @@
 #include "../DSPCode/rosic_Open303.h"
+#include "../DSPCode/rosic_RealtimeAudit.h"
 #include "o303cids.h"
 #include "o303pids.h"
 
@@ -7,7 +8,6 @@
 #include "vst3utils/parameter_changes_iterator.h"
 #include "vst3utils/parameter_updater.h"
 #include "public.sdk/source/vst/utility/audiobuffers.h"
-#include "public.sdk/source/vst/utility/processdataslicer.h"
 #include "public.sdk/source/vst/utility/rttransfer.h"
 #include "public.sdk/source/vst/utility/sampleaccurate.h"
 #include "public.sdk/source/vst/vstaudioeffect.h"
@@ -16,6 +16,8 @@
 #include "pluginterfaces/vst/ivstprocesscontext.h"
 #include "pluginterfaces/vst/ivstunits.h"
 
+#include <algorithm>
+
 //------------------------------------------------------------------------
 namespace o303 {
 
@@ -26,6 +28,9 @@ using ParameterUpdater = vst3utils::throttled_parameter_updater;
 using vst3utils::begin;
 using vst3utils::end;
 
+// the time (in ms) over which the continuous parameters ramp to a new value
+static constexpr auto SmoothingTime = 5.;
+
 //------------------------------------------------------------------------
 enum class ChordFollow
 {
@@ -51,19 +56,10 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 		setControllerClass (ControllerUID);
 		processContextRequirements.needTempo ();
 
-		parameter[asIndex (ParameterID::DecayMode)].set_alpha (1.);
-		parameter[asIndex (ParameterID::Filter_Type)].set_alpha (1.);
-		parameter[asIndex (ParameterID::SeqActivePattern)].set_alpha (1.);
-
 		for (auto index = 0u; index < parameter.size (); ++index)
 		{
-#ifdef O303_EXTENDED_PARAMETERS
-			if (index >= asIndex (ParameterID::Amp_Sustain))
-				parameter[index].set_alpha (1.);
-#endif
 			parameter[index].set (parameterDescriptions[index].default_normalized);
-
-			updateParameter (index, parameter[index]);
+			updateParameter (index, parameter[index].get ());
 		}
 		auto pid = asIndex (SeqPatternParameterID::NumSteps);
 		for (const auto& desc : seqParameterDescriptions)
@@ -109,7 +105,11 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 		{
 			peakUpdater.init (newSetup.sampleRate);
 			seqStepUpdater.init (newSetup.sampleRate);
-			open303Core.sequencer.setSampleRate (newSetup.sampleRate);
+			open303Core.setSampleRate (newSetup.sampleRate);
+			open303Core.setSmoothingTime (SmoothingTime);
+			// waveform changes are rendered in the background, except for offline rendering
+			// where they should take effect immediately
+			open303Core.setAsynchronousWaveformRendering (newSetup.processMode != Vst::kOffline);
 		}
 		return result;
 	}
@@ -209,15 +209,52 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 		for (auto paramQueue : inputParameterChanges)
 		{
 			for (auto point : paramQueue)
+				setParameter (point.pid, point.value);
+		}
+	}
+
+	// applies the parameter changes at the sample offset position and returns the offset of the
+	// next change (or numSamples). The points of a queue are sorted by their offsets and we are
+	// called for every offset in turn, so the points before position are applied already.
+	int32 handleParameterChangesAt (IParameterChanges* changes, int32 position, int32 numSamples)
+	{
+		auto nextPosition = numSamples;
+		if (!changes)
+			return nextPosition;
+		for (auto queueIndex = 0; queueIndex < changes->getParameterCount (); ++queueIndex)
+		{
+			auto queue = changes->getParameterData (queueIndex);
+			if (!queue)
+				continue;
+			for (auto pointIndex = 0; pointIndex < queue->getPointCount (); ++pointIndex)
 			{
-				if (point.pid < parameter.size ())
-					parameter[point.pid].set (point.value);
-				else
+				int32 sampleOffset;
+				ParamValue value;
+				if (queue->getPoint (pointIndex, sampleOffset, value) != kResultTrue)
+					continue;
+				sampleOffset = std::clamp (sampleOffset, 0, numSamples - 1);
+				if (sampleOffset < position)
+					continue;
+				if (sampleOffset > position)
 				{
-					setSeqParameter (point.pid, point.value);
+					nextPosition = std::min (nextPosition, sampleOffset);
+					break;
 				}
+				setParameter (queue->getParameterId (), value);
 			}
 		}
+		return nextPosition;
+	}
+
+	void setParameter (ParamID pid, ParamValue value)
+	{
+		if (pid >= parameter.size ())
+			setSeqParameter (pid, value);
+		else if (parameter[pid].get () != value)
+		{
+			parameter[pid].set (value);
+			updateParameter (pid, value);
+		}
 	}
 
 	int getActivePattern () const { return open303Core.sequencer.getActivePattern (); }
@@ -296,19 +333,24 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 		switch (static_cast<ParameterID> (index))
 		{
 			case ParameterID::Waveform:
-				open303Core.setWaveform (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::WAVEFORM,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Tuning:
-				open303Core.setTuning (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::TUNING,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Cutoff:
-				open303Core.setCutoff (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::CUTOFF,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Resonance:
-				open303Core.setResonance (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::RESONANCE,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Envmod:
-				open303Core.setEnvMod (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::ENVMOD,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Decay:
 				open303Core.setDecay ((*decayValueFunc) (value));
@@ -317,13 +359,15 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 				open303Core.setAccent (pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Volume:
-				open303Core.setVolume (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::VOLUME,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::Filter_Type:
 				open303Core.filter.setMode (pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::PitchBend:
-				open303Core.setPitchBend (pd[index].convert.to_plain (value));
+				open303Core.setParameterSmoothly (rosic::Open303::PITCHBEND,
+											  pd[index].convert.to_plain (value));
 				break;
 			case ParameterID::AudioPeak:
 				break;
@@ -331,7 +375,7 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 				decayValueFunc =
 					value < 0.5 ? &decayParamValueFunc.to_plain : &decayAltParamValueFunc.to_plain;
 				updateParameter (asIndex (ParameterID::Decay),
-								 parameter[asIndex (ParameterID::Decay)]);
+								 parameter[asIndex (ParameterID::Decay)].get ());
 				break;
 			case ParameterID::SeqMode:
 				open303Core.sequencer.setMode (pd[index].convert.to_plain (value));
@@ -344,6 +388,16 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 			case ParameterID::SeqActivePattern:
 				open303Core.sequencer.setActivePattern (pd[index].convert.to_plain (value) - 1);
 				break;
+			case ParameterID::Oversampling:
+			{
+				auto exponent = static_cast<int> (pd[index].convert.to_plain (value));
+				open303Core.setOversampling (1 << exponent);
+				break;
+			}
+			case ParameterID::Oscillator:
+				open303Core.setOscillatorAlgorithm (
+					static_cast<int> (pd[index].convert.to_plain (value)));
+				break;
 #ifdef O303_EXTENDED_PARAMETERS
 			case ParameterID::Amp_Sustain:
 				open303Core.setAmpSustain (pd[index].convert.to_plain (value));
@@ -418,64 +472,78 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 	}
 
 	template<SymbolicSampleSizes SampleSize>
-	void processSliced (Steinberg::Vst::ProcessData& data)
+	void processSampleAccurate (Steinberg::Vst::ProcessData& data)
 	{
 		using SampleType =
 			std::conditional_t<SampleSize == SymbolicSampleSizes::kSample32, float, double>;
 
-		static constexpr auto SampleAccuracy = 4;
-
 		auto eventIterator = begin (data.inputEvents);
 		auto eventEndIterator = end (data.inputEvents);
 		advanceToNextNoteEvent (eventIterator, eventEndIterator);
-		auto sampleCounter = SampleAccuracy;
-		auto peak = static_cast<SampleType> (0.);
 
-		ProcessDataSlicer slicer (SampleAccuracy);
-		slicer.process<SampleSize> (data, [&] (ProcessData& data) {
-			for (auto index = 0u; index < parameter.size (); ++index)
+		auto& outs = data.outputs[0];
+		auto left = getChannelBuffers<SampleSize> (outs)[0];
+		auto right = getChannelBuffers<SampleSize> (outs)[1];
+
+		int32 position = 0;
+		auto nextParameterChange =
+			handleParameterChangesAt (data.inputParameterChanges, position, data.numSamples);
+
+		if (open303Core.isIdle () && eventIterator == eventEndIterator)
+		{
+			// nothing plays and no note starts in this block, so skip the rendering
+			while (nextParameterChange < data.numSamples)
+				nextParameterChange = handleParameterChangesAt (
+					data.inputParameterChanges, nextParameterChange, data.numSamples);
+			std::fill_n (left, data.numSamples, static_cast<SampleType> (0.));
+			std::fill_n (right, data.numSamples, static_cast<SampleType> (0.));
+			outs.silenceFlags = 0x3;
+			updateDisplayParameters (0., data);
+			return;
+		}
+
+		// the block is only split where a note or parameter change happens, the parameters ramp
+		// per sample inside the core
+		while (position < data.numSamples)
+		{
+			while (eventIterator != eventEndIterator && eventIterator->sampleOffset <= position)
 			{
-				auto& p = parameter[index];
-				auto old = *p;
-				if (p.process () != old)
-				{
-					updateParameter (index, *p);
-				}
+				handleEvent (*eventIterator);
+				++eventIterator;
+				advanceToNextNoteEvent (eventIterator, eventEndIterator);
 			}
+			auto nextPosition = nextParameterChange;
 			if (eventIterator != eventEndIterator)
-			{
-				eventIterator->sampleOffset -= data.numSamples;
-				while (eventIterator->sampleOffset <= 0)
-				{
-					handleEvent (*eventIterator);
-					++eventIterator;
-					advanceToNextNoteEvent (eventIterator, eventEndIterator);
-					if (eventIterator == eventEndIterator)
-						break;
-					eventIterator->sampleOffset -= sampleCounter;
-				}
-			}
+				nextPosition = std::min (nextPosition, eventIterator->sampleOffset);
 
-			auto& outs = data.outputs[0];
-			auto left = getChannelBuffers<SampleSize> (outs)[0];
-			auto right = getChannelBuffers<SampleSize> (outs)[1];
-			for (auto index = 0; index < data.numSamples; ++index, ++left, ++right)
-			{
-				*left = *right = static_cast<SampleType> (open303Core.getSample ());
-				assert (!isnan (*left));
-				assert (!isinf (*left));
-				peak += std::abs (*left);
-			}
-			sampleCounter += data.numSamples;
-		});
+			open303Core.processBlock (left + position, nextPosition - position);
+			position = nextPosition;
+			if (position == nextParameterChange && position < data.numSamples)
+				nextParameterChange =
+					handleParameterChangesAt (data.inputParameterChanges, position, data.numSamples);
+		}
+
+		auto peak = static_cast<SampleType> (0.);
+		for (auto index = 0; index < data.numSamples; ++index)
+		{
+			right[index] = left[index];
+			assert (!isnan (left[index]));
+			assert (!isinf (left[index]));
+			peak += std::abs (left[index]);
+		}
 
 		if (peak == static_cast<SampleType> (0.))
 		{
-			data.outputs[0].silenceFlags = 0x3;
+			outs.silenceFlags = 0x3;
 		}
 
-		peakUpdater.process (
-			vst3utils::exp_to_normalized<ParamValue> (0.00001, 1., peak / data.numSamples), data);
+		updateDisplayParameters (peak / data.numSamples, data);
+	}
+
+	void updateDisplayParameters (double averagePeak, ProcessData& data)
+	{
+		peakUpdater.process (vst3utils::exp_to_normalized<ParamValue> (0.00001, 1., averagePeak),
+							 data);
 		seqStepUpdater.process (
 			vst3utils::steps_to_normalized (MaxSeqPatternSteps - 1, 0,
 											open303Core.sequencer.getCurrentPlayingStep ()),
@@ -484,25 +552,25 @@ struct Processor : U::Extends<AudioEffect, U::Directly<IUnitData>>
 
 	tresult PLUGIN_API process (Steinberg::Vst::ProcessData& data) override
 	{
+		// reports allocations, locks and blocking calls in builds with O303_RT_AUDIT
+		rosic::RealtimeAudit::AudioThreadScope auditScope (data.processMode != Vst::kOffline);
 		paramTransfer.accessTransferObject_rt ([this] (auto& param) {
 			for (auto index = 0u; index < param.size () && index < parameter.size (); ++index)
-			{
-				parameter[index].set (param[index].get ());
-			}
+				setParameter (index, param[index].get ());
 		});
-		if (data.inputParameterChanges)
-			handleParameterChanges (data.inputParameterChanges);
-
 		if (data.numSamples <= 0)
+		{
+			handleParameterChanges (data.inputParameterChanges);
 			return kResultTrue;
+		}
 
 		if (data.processContext && data.processContext->state & ProcessContext::kTempoValid)
 			open303Core.sequencer.setTempo (data.processContext->tempo);
 
 		if (processSetup.symbolicSampleSize == SymbolicSampleSizes::kSample32)
-			processSliced<SymbolicSampleSizes::kSample32> (data);
+			processSampleAccurate<SymbolicSampleSizes::kSample32> (data);
 		else
-			processSliced<SymbolicSampleSizes::kSample64> (data);
+			processSampleAccurate<SymbolicSampleSizes::kSample64> (data);
 
 		return kResultTrue;
 	}